@@ -0,0 +1,243 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+    #include <fcntl.h>
+    #include <sys/file.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+#include "../Models/Search.h"
+
+using namespace std;
+
+// Кэш анализа на диске: результаты поиска из корня (хеш позиции, уровень, оценка, лучший ход), которые
+// переживают перезапуск игры и программы. Файл отображается в память (mmap), поэтому записи попадают на диск
+// без отдельного сохранения, а при запуске не читаются целиком
+// Формат: заголовок (магия "CKA1", версия, размер записи, количество записей), затем записи analysis_entry.
+// Таблица с потерями: ключ определяет пару соседних записей, из них вытесняется менее глубокая
+// Файл с другой версией или поврежденным заголовком создается заново, с другим размером - перестраивается
+// под AnalysisCacheMB (остаются самые глубокие записи); новый файл заменяет старый целиком (rename) под
+// блокировкой flock, поэтому процессы с тем же файлом могут работать одновременно. Каждая запись
+// проверяется по контрольной сумме
+// Только POSIX: под Windows конструктор бросает runtime_error
+class AnalysisCache
+{
+  public:
+    static const uint32_t VERSION = 1;
+
+    // Параметр megabytes: предельный размер файла (округляется вниз до степени двойки записей, не меньше двух)
+    // Параметр salt: смешивается с ключами, чтобы результаты разных настроек бота не смешивались в одном файле
+    AnalysisCache(const string &path, const size_t megabytes, const uint64_t salt = 0) : salt(salt)
+    {
+#ifdef _WIN32
+        throw runtime_error("analysis cache is not supported on Windows");
+#else
+        size_t count = 2;
+        while (sizeof(file_header) + count * 2 * sizeof(analysis_entry) <= megabytes * 1024 * 1024)
+            count *= 2;
+        // Блокировка на время проверки и перестройки: процессы, открывающие файл одновременно, ждут друг друга
+        // Если, пока ждали, файл был заменен другим процессом, открываем новый
+        while (true)
+        {
+            fd = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+            if (fd < 0)
+                throw runtime_error("can't open analysis cache " + path);
+            struct stat locked, current;
+            if (flock(fd, LOCK_EX) != 0)
+                fail("can't lock analysis cache " + path);
+            if (fstat(fd, &locked) == 0 && stat(path.c_str(), &current) == 0 && locked.st_ino == current.st_ino &&
+                locked.st_dev == current.st_dev)
+                break;
+            close(fd);
+        }
+        vector<analysis_entry> old;
+        file_header header;
+        struct stat st;
+        const bool valid = (fstat(fd, &st) == 0 && size_t(st.st_size) >= sizeof(header) &&
+                            pread(fd, &header, sizeof(header), 0) == ssize_t(sizeof(header)) &&
+                            !memcmp(header.magic, "CKA1", 4) && header.version == VERSION &&
+                            header.entry_size == sizeof(analysis_entry) &&
+                            size_t(st.st_size) == sizeof(header) + header.count * sizeof(analysis_entry));
+        if (valid && header.count != count)
+        {
+            // Другой размер: переносим записи в новую таблицу
+            old.resize(header.count);
+            if (pread(fd, old.data(), old.size() * sizeof(analysis_entry), sizeof(header)) !=
+                ssize_t(old.size() * sizeof(analysis_entry)))
+                old.clear();
+        }
+        const bool reuse = (valid && header.count == count);
+        mapping_size = sizeof(header) + count * sizeof(analysis_entry);
+        if (reuse)
+        {
+            if (!map_file())
+                fail("can't map analysis cache " + path);
+            flock(fd, LOCK_UN);
+            return;
+        }
+        // Новая таблица строится во временном файле и подменяет старый файл через rename: другие процессы
+        // продолжают работать со старым отображением (их новые записи в него теряются), а изменять размер
+        // отображенного ими файла нельзя - обращение за конец файла завершает процесс сигналом SIGBUS
+        const int old_fd = fd;
+        const string temp_path = path + ".tmp" + to_string(getpid());
+        fd = open(temp_path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0)
+        {
+            fd = old_fd;
+            fail("can't create analysis cache " + temp_path);
+        }
+        // Новый файл заполнен нулями; заголовок записывается после записей
+        if (ftruncate(fd, off_t(mapping_size)) != 0 || !map_file())
+        {
+            unlink(temp_path.c_str());
+            close(old_fd);
+            fail("can't create analysis cache " + temp_path);
+        }
+        for (size_t i = 0; i < count; ++i)
+            table[i].depth = -1;
+        // Самые глубокие записи первыми, чтобы при уменьшении таблицы вытеснялись мелкие
+        sort(old.begin(), old.end(), [](const analysis_entry &a, const analysis_entry &b) { return a.depth > b.depth; });
+        for (auto &entry : old)
+        {
+            if (entry.depth >= 0 && entry.check == checksum(entry))
+                put(entry);
+        }
+        memcpy(header.magic, "CKA1", 4);
+        header.version = VERSION;
+        header.entry_size = sizeof(analysis_entry);
+        header.count = count;
+        memcpy(mapping, &header, sizeof(header));
+        msync(mapping, mapping_size, MS_SYNC);
+        const bool renamed = (rename(temp_path.c_str(), path.c_str()) == 0);
+        close(old_fd);  // Снимает блокировку старого файла
+        if (!renamed)
+        {
+            unlink(temp_path.c_str());
+            munmap(mapping, mapping_size);
+            mapping = nullptr;
+            fail("can't replace analysis cache " + path);
+        }
+#endif
+    }
+
+    AnalysisCache(const AnalysisCache &) = delete;
+    AnalysisCache &operator=(const AnalysisCache &) = delete;
+
+    // Сбрасывает изменения на диск и закрывает файл
+    ~AnalysisCache()
+    {
+#ifndef _WIN32
+        if (mapping)
+        {
+            msync(mapping, mapping_size, MS_SYNC);
+            munmap(mapping, mapping_size);
+        }
+        if (fd >= 0)
+            close(fd);
+#endif
+    }
+
+    // Ищет результат для позиции с хешем key; возвращает false, если его нет
+    bool probe(const uint64_t key, analysis_entry &entry) const
+    {
+        const uint64_t salted = key ^ salt;
+        const size_t index = size_t(salted & mask) & ~size_t(1);
+        for (size_t i = index; i < index + 2; ++i)
+        {
+            if (table[i].key == salted && table[i].depth >= 0 && table[i].check == checksum(table[i]))
+            {
+                entry = table[i];
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Сохраняет результат (поле key - хеш позиции без соли); запись для той же позиции заменяется, если не глубже
+    void store(analysis_entry entry)
+    {
+        entry.key ^= salt;
+        entry.check = checksum(entry);
+        put(entry);
+    }
+
+    // Количество записей
+    size_t size() const
+    {
+        return mask + 1;
+    }
+
+  private:
+    struct file_header
+    {
+        char magic[4];
+        uint32_t version;
+        uint32_t entry_size;
+        uint32_t reserved = 0;
+        uint64_t count;
+    };
+
+    static uint32_t checksum(const analysis_entry &entry)
+    {
+        uint64_t z = entry.key ^ (uint64_t(uint32_t(entry.score)) << 32) ^ (uint64_t(uint16_t(entry.depth)) << 16) ^
+                     (uint64_t(entry.from) << 8) ^ entry.to;
+        z = (z ^ entry.beats ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return uint32_t(z ^ (z >> 31)) | 1u;  // Не ноль: пустая запись из нулей не проходит проверку
+    }
+
+    void put(const analysis_entry &entry)
+    {
+        const size_t index = size_t(entry.key & mask) & ~size_t(1);
+        size_t slot = index;
+        for (size_t i = index; i < index + 2; ++i)
+        {
+            if (table[i].key == entry.key && table[i].depth >= 0)
+            {
+                if (entry.depth >= table[i].depth || table[i].check != checksum(table[i]))
+                    table[i] = entry;
+                return;
+            }
+            if (table[i].depth < table[slot].depth)
+                slot = i;
+        }
+        if (entry.depth >= table[slot].depth || table[slot].check != checksum(table[slot]))
+            table[slot] = entry;
+    }
+
+#ifndef _WIN32
+    // Отображает открытый файл fd размера mapping_size в память; возвращает false при ошибке
+    bool map_file()
+    {
+        void *ptr = mmap(nullptr, mapping_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (ptr == MAP_FAILED)
+            return false;
+        mapping = static_cast<uint8_t *>(ptr);
+        table = reinterpret_cast<analysis_entry *>(mapping + sizeof(file_header));
+        mask = (mapping_size - sizeof(file_header)) / sizeof(analysis_entry) - 1;
+        return true;
+    }
+
+    [[noreturn]] void fail(const string &message)
+    {
+        close(fd);
+        fd = -1;
+        throw runtime_error(message);
+    }
+#endif
+
+    uint64_t salt;
+    int fd = -1;
+    uint8_t *mapping = nullptr;
+    size_t mapping_size = 0;
+    analysis_entry *table = nullptr;
+    size_t mask = 0;
+};
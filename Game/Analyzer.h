@@ -0,0 +1,160 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+#include "../Models/Search.h"
+#include "Config.h"
+#include "Logic.h"
+#include "Notation.h"
+
+using namespace std;
+
+// Пакетный анализ позиций: читает позиции (по одной FEN в строке) из потока,
+// ищет лучший ход в нескольких рабочих потоках и выводит результаты в порядке входа
+// Строка результата: "<FEN>\t<лучший ход>\t<оценка>\t<уровень>\t<позиций>\t<главный вариант>",
+// в режиме multi-PV за ней следуют остальные лучшие ходы: "\t<ход>\t<оценка>\t<главный вариант>"
+// Пустые строки и строки, начинающиеся с '#', переносятся в вывод без изменений
+class Analyzer
+{
+  public:
+    // Параметр threads: количество рабочих потоков (0 - по числу ядер)
+    // Параметр limits: ограничения поиска для каждой позиции (уровень или время)
+    // Параметр multi_pv: сколько лучших ходов выводить для каждой позиции
+    Analyzer(Config *config, unsigned threads, const search_limits &limits, const size_t multi_pv = 1)
+        : config(config), limits(limits), multi_pv(multi_pv)
+    {
+        threads_count = threads ? threads : max(1u, thread::hardware_concurrency());
+        // Окно переупорядочивания: сколько позиций может находиться в обработке одновременно
+        window = 64 * threads_count;
+    }
+
+    // Анализирует все позиции из in и пишет результаты в out
+    // Возвращает количество проанализированных позиций
+    size_t run(istream &in, ostream &out)
+    {
+        vector<thread> workers;
+        for (unsigned i = 0; i < threads_count; ++i)
+            workers.emplace_back(&Analyzer::worker, this);
+        thread reader(&Analyzer::reader, this, ref(in));
+
+        // Главный поток выводит результаты строго по порядку номеров строк
+        while (true)
+        {
+            string line;
+            {
+                unique_lock<mutex> lock(queue_mtx);
+                done_cv.wait(lock, [this] { return results.count(written) || (input_over && written == read_count); });
+                if (!results.count(written))
+                    break;
+                line = move(results[written]);
+                results.erase(written);
+                ++written;
+            }
+            space_cv.notify_one();
+            out << line << '\n';
+        }
+        out.flush();
+        reader.join();
+        for (auto &th : workers)
+            th.join();
+        return analyzed;
+    }
+
+  private:
+    // Поток чтения: раздает строки рабочим, не опережая вывод больше чем на window строк
+    void reader(istream &in)
+    {
+        string line;
+        size_t index = 0;
+        while (getline(in, line))
+        {
+            unique_lock<mutex> lock(queue_mtx);
+            space_cv.wait(lock, [this] { return read_count - written < window; });
+            tasks.emplace_back(index++, move(line));
+            ++read_count;
+            lock.unlock();
+            task_cv.notify_one();
+        }
+        {
+            lock_guard<mutex> lock(queue_mtx);
+            input_over = true;
+        }
+        task_cv.notify_all();
+        done_cv.notify_all();
+    }
+
+    // Рабочий поток: у каждого свой экземпляр Logic, общих данных поиска нет
+    void worker()
+    {
+        Logic logic(config);
+        logic.multi_pv = multi_pv;
+        while (true)
+        {
+            pair<size_t, string> task;
+            {
+                unique_lock<mutex> lock(queue_mtx);
+                task_cv.wait(lock, [this] { return !tasks.empty() || input_over; });
+                if (tasks.empty())
+                    return;
+                task = move(tasks.front());
+                tasks.pop_front();
+            }
+            auto res = analyze(logic, task.second);
+            {
+                lock_guard<mutex> lock(queue_mtx);
+                results[task.first] = move(res);
+            }
+            done_cv.notify_one();
+        }
+    }
+
+    // Анализирует одну строку входа и возвращает строку результата
+    string analyze(Logic &logic, const string &line)
+    {
+        if (line.empty() || line[0] == '#')
+            return line;
+        stringstream out;
+        try
+        {
+            vector<vector<POS_T>> mtx;
+            bool color;
+            parse_fen(line, mtx, color);
+            search_info last;
+            auto best = logic.search(mtx, color, limits, [&last](const search_info &info) { last = info; });
+            out << line << '\t' << turns_to_string(best) << '\t' << last.score << '\t' << last.depth << '\t' << logic.nodes
+                << '\t' << pv_to_string(last.pv);
+            for (size_t i = 1; i < last.lines.size(); ++i)
+                out << '\t' << turns_to_string(last.lines[i].turns) << '\t' << last.lines[i].score << '\t'
+                    << pv_to_string(last.lines[i].pv);
+            lock_guard<mutex> lock(queue_mtx);
+            ++analyzed;
+        }
+        catch (const exception &e)
+        {
+            out << line << "\terror: " << e.what();
+        }
+        return out.str();
+    }
+
+  private:
+    Config *config;
+    search_limits limits;
+    size_t multi_pv;
+    unsigned threads_count;
+    size_t window;
+    deque<pair<size_t, string>> tasks;  // Прочитанные, но не взятые в работу строки
+    map<size_t, string> results;        // Готовые результаты, ожидающие вывода по порядку
+    size_t read_count = 0;              // Сколько строк прочитано
+    size_t written = 0;                 // Сколько строк выведено
+    size_t analyzed = 0;                // Сколько позиций успешно проанализировано
+    bool input_over = false;            // Входной поток закончился
+    mutex queue_mtx;
+    condition_variable task_cv;         // Появилась задача или вход закончился
+    condition_variable done_cv;         // Появился результат
+    condition_variable space_cv;        // Освободилось место в окне
+};
@@ -97,6 +97,7 @@ public:
         game_results = -1;
         history_mtx.clear();
         history_beat_series.clear();
+        history_turns.clear();
         make_start_mtx();
         clear_active();
         clear_highlight();
@@ -104,28 +105,28 @@ public:
 
     void move_piece(move_pos turn, const int beat_series = 0)
     {
+        if (mtx[turn.x2][turn.y2])
+        {
+            throw runtime_error("final position is not empty, can't move");
+        }
+        if (!mtx[turn.x][turn.y])
+        {
+            throw runtime_error("begin position is empty, can't move");
+        }
         if (turn.xb != -1)
         {
             mtx[turn.xb][turn.yb] = 0;
         }
-        move_piece(turn.x, turn.y, turn.x2, turn.y2, beat_series);
+        if ((mtx[turn.x][turn.y] == 1 && turn.x2 == 0) || (mtx[turn.x][turn.y] == 2 && turn.x2 == 7))
+            mtx[turn.x][turn.y] += 2;
+        mtx[turn.x2][turn.y2] = mtx[turn.x][turn.y];
+        drop_piece(turn.x, turn.y);
+        add_history(beat_series, turn);
     }
 
     void move_piece(const POS_T i, const POS_T j, const POS_T i2, const POS_T j2, const int beat_series = 0)
     {
-        if (mtx[i2][j2])
-        {
-            throw runtime_error("final position is not empty, can't move");
-        }
-        if (!mtx[i][j])
-        {
-            throw runtime_error("begin position is empty, can't move");
-        }
-        if ((mtx[i][j] == 1 && i2 == 0) || (mtx[i][j] == 2 && i2 == 7))
-            mtx[i][j] += 2;
-        mtx[i2][j2] = mtx[i][j];
-        drop_piece(i, j);
-        add_history(beat_series);
+        move_piece(move_pos(i, j, i2, j2), beat_series);
     }
 
     void drop_piece(const POS_T i, const POS_T j)
@@ -148,6 +149,33 @@ public:
         return mtx;
     }
 
+    // Заменяет начальную позицию (например, позицией из тега FEN загруженной партии)
+    // История ходов очищается
+    void set_start_board(const vector<vector<POS_T>> &start_mtx)
+    {
+        mtx = start_mtx;
+        history_mtx.clear();
+        history_beat_series.clear();
+        history_turns.clear();
+        add_history();
+        rerender();
+    }
+
+    // Возвращает сделанные ходы партии, сгруппированные по сериям взятий
+    // (каждый элемент - полный ход одной стороны)
+    vector<vector<move_pos>> get_history_turns() const
+    {
+        vector<vector<move_pos>> res;
+        for (size_t i = 1; i < history_turns.size(); ++i)
+        {
+            // Новый ход начинается с тихого хода или с первого взятия серии
+            if (res.empty() || history_beat_series[i] <= 1)
+                res.emplace_back();
+            res.back().push_back(history_turns[i]);
+        }
+        return res;
+    }
+
     void highlight_cells(vector<pair<POS_T, POS_T>> cells)
     {
         for (auto pos : cells)
@@ -193,6 +221,7 @@ public:
         {
             history_mtx.pop_back();
             history_beat_series.pop_back();
+            history_turns.pop_back();
         }
         mtx = *(history_mtx.rbegin());
         clear_highlight();
@@ -233,10 +262,11 @@ public:
     }
 
 private:
-    void add_history(const int beat_series = 0)
+    void add_history(const int beat_series = 0, const move_pos turn = move_pos(-1, -1, -1, -1))
     {
         history_mtx.push_back(mtx);
         history_beat_series.push_back(beat_series);
+        history_turns.push_back(turn);
     }
     // function to make start matrix
     void make_start_mtx()
@@ -391,4 +421,6 @@ private:
     vector<vector<POS_T>> mtx = vector<vector<POS_T>>(8, vector<POS_T>(8, 0));
     // series of beats for each move
     vector<int> history_beat_series;
+    // move that led to each board of history (the first one is empty)
+    vector<move_pos> history_turns;
 };
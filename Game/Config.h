@@ -1,10 +1,13 @@
 #pragma once
 #include <fstream>
+#include <string>
 #include <nlohmann/json.hpp>
 using json = nlohmann::json;
 
 #include "../Models/Project_path.h"
 
+using namespace std;
+
 class Config
 {
   public:
@@ -19,6 +22,8 @@ class Config
     void reload()
     {
         std::ifstream fin(project_path + "settings.json");
+        if (!fin.is_open())
+            return;  // Без файла остаются значения по умолчанию (см. set_default)
         fin >> config;
         fin.close();
     }
@@ -27,11 +32,29 @@ class Config
     // Позволяет обращаться к вложенным JSON-значениям через синтаксис config("раздел", "параметр")
     // Например: config("Bot", "IsWhiteBot") вместо config.config["Bot"]["IsWhiteBot"]
     // Возвращает значение настройки из JSON по указанному пути
-    auto operator()(const string &setting_dir, const string &setting_name) const
+    // Для отсутствующей настройки возвращает null (новые настройки могут отсутствовать в старых settings.json)
+    json operator()(const string &setting_dir, const string &setting_name) const
     {
+        if (!config.contains(setting_dir) || !config[setting_dir].contains(setting_name))
+            return json();
         return config[setting_dir][setting_name];
     }
 
+    // Изменяет значение настройки только в памяти (файл settings.json не перезаписывается)
+    // Используется консольными утилитами, например командой setoption протокола движка
+    void set(const string &setting_dir, const string &setting_name, const json &value)
+    {
+        config[setting_dir][setting_name] = value;
+    }
+
+    // Задает значение настройки, только если она отсутствует в settings.json
+    // Позволяет консольным утилитам работать без файла настроек
+    void set_default(const string &setting_dir, const string &setting_name, const json &value)
+    {
+        if (!config.contains(setting_dir) || !config[setting_dir].contains(setting_name))
+            config[setting_dir][setting_name] = value;
+    }
+
   private:
     json config;
 };
@@ -0,0 +1,206 @@
+#pragma once
+#include <deque>
+#include <iostream>
+#include <vector>
+
+#ifndef _WIN32
+    #include <poll.h>
+#endif
+
+#include "Config.h"
+#include "Net.h"
+#include "TrainingData.h"
+#include "Worker.h"
+
+using namespace std;
+
+// Задание для распределенной работы: партии делятся на единицы по unit_games подряд идущих номеров
+struct farm_job
+{
+    string type = "selfplay";   // "selfplay" - обучающие данные, "match" - матч MCTS против альфа-беты (Game/Match.h)
+    size_t games = 1000;        // Всего партий
+    size_t unit_games = 10;     // Партий в одной единице работы
+    json bot = json::object();  // Настройки раздела "Bot" для рабочих (поверх их settings.json)
+    int depth = -1;             // Уровень бота альфа-бета (или -1)
+    int64_t nodes = -1;         // Бюджет позиций на ход (или -1)
+    int random_plies = 8;       // Случайных полуходов дебюта
+    int max_plies = 200;        // Ничья после стольких полуходов
+    unsigned seed = 0;          // Зерно дебютов самоигры
+};
+
+// Координатор: раздает единицы работы рабочим процессам (Game/Worker.h) и собирает результаты
+// Один поток, poll по всем соединениям. Единица засчитывается только целиком: если рабочий отключился
+// (упал) до ответа, его единица возвращается в начало очереди и достается другому, поэтому партии не теряются
+// и не засчитываются дважды. Записи самоигры идут в TrainingWriter, результаты матча - в статистику
+class Coordinator
+{
+  public:
+    // Начинает слушать address; writer нужен для самоигры (может быть nullptr для матча)
+    Coordinator(const string &address, const farm_job &job, TrainingWriter *writer)
+        : job(job), writer(writer), server(LineSocket::listen_on(address))
+    {
+        for (size_t first = 0; first < job.games; first += job.unit_games)
+            pending.push_back(units.size()), units.push_back({first, min(job.unit_games, job.games - first)});
+        done.assign(units.size(), false);
+    }
+
+    // Работает, пока не выполнены все единицы; затем отправляет рабочим done
+    void run()
+    {
+#ifndef _WIN32
+        while (done_count < units.size())
+        {
+            vector<pollfd> fds(clients.size() + 1);
+            fds[0] = {server.fd, POLLIN, 0};
+            for (size_t i = 0; i < clients.size(); ++i)
+                fds[i + 1] = {clients[i].sock.fd, POLLIN, 0};
+            if (poll(fds.data(), fds.size(), -1) < 0)
+                continue;
+            for (size_t i = clients.size(); i-- > 0;)
+            {
+                if (!fds[i + 1].revents)
+                    continue;
+                if (!clients[i].sock.receive() || !handle(clients[i]))
+                    drop(i);
+            }
+            if (fds[0].revents & POLLIN)
+            {
+                client c;
+                c.sock = server.accept_client();
+                if (c.sock.fd >= 0)
+                {
+                    clients.push_back(move(c));
+                    ++workers_seen;
+                }
+            }
+            // Свободным рабочим - следующие единицы (в том числе вернувшиеся от упавших рабочих)
+            for (size_t i = clients.size(); i-- > 0;)
+            {
+                if (clients[i].ready && clients[i].unit < 0 && !pending.empty() && !assign(clients[i]))
+                    drop(i);
+            }
+        }
+        for (auto &c : clients)
+            c.sock.send_line(json{{"type", "done"}}.dump());
+        clients.clear();
+#endif
+    }
+
+    // Статистика
+    uint64_t results[3] = {0, 0, 0};        // Матч: поражения, ничьи и выигрыши MCTS
+    double ab_ms = 0, mcts_ms = 0;          // Матч: время ходов ботов
+    uint64_t ab_moves = 0, mcts_moves = 0;
+    uint64_t positions = 0;                 // Самоигра: полученных позиций
+    size_t requeued = 0;                    // Единиц, возвращенных в очередь из-за отключения рабочего
+    size_t workers_seen = 0;                // Подключавшихся рабочих
+
+  private:
+    struct work_unit
+    {
+        size_t first, count;
+    };
+
+    struct client
+    {
+        LineSocket sock;
+        long unit = -1;     // Выданная единица (-1 - нет)
+        bool ready = false; // Рабочий представился
+    };
+
+    // Разбирает принятые строки; возвращает false на ошибке протокола
+    bool handle(client &c)
+    {
+        string line;
+        while (c.sock.next_line(line))
+        {
+            try
+            {
+                const json msg = json::parse(line);
+                const string type = msg.value("type", "");
+                if (type == "ready")
+                    c.ready = true;
+                else if (type == "result")
+                {
+                    const long id = msg.at("id");
+                    if (id != c.unit)
+                        return false;
+                    commit(size_t(id), msg);
+                    c.unit = -1;
+                }
+            }
+            catch (const exception &e)
+            {
+                cerr << "Bad message from worker: " << e.what() << "\n";
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Засчитывает результат единицы id
+    void commit(const size_t id, const json &msg)
+    {
+        if (done[id])
+            return;
+        // Сначала разбираем целиком, чтобы ошибка не оставила единицу засчитанной наполовину
+        vector<vector<training_record>> games;
+        for (auto &game : msg.at("games"))
+        {
+            if (job.type == "match")
+                ++results[min(2, max(0, int(game.at("result"))))];
+            else
+                games.push_back(records_from_hex(game.at("records")));
+        }
+        for (auto &records : games)
+        {
+            for (auto &record : records)
+                writer->add(record);
+            positions += records.size();
+        }
+        ab_ms += msg.value("ab_ms", 0.0);
+        mcts_ms += msg.value("mcts_ms", 0.0);
+        ab_moves += msg.value("ab_moves", uint64_t(0));
+        mcts_moves += msg.value("mcts_moves", uint64_t(0));
+        done[id] = true;
+        ++done_count;
+        cerr << "\rUnits done: " << done_count << "/" << units.size() << flush;
+        if (done_count == units.size())
+            cerr << "\n";
+    }
+
+    // Выдает рабочему следующую единицу; возвращает false, если соединение разорвано
+    bool assign(client &c)
+    {
+        const size_t id = pending.front();
+        pending.pop_front();
+        c.unit = long(id);
+        json unit = {{"type", "unit"},          {"id", id},
+                     {"job", job.type},         {"first", units[id].first},
+                     {"count", units[id].count}, {"bot", job.bot},
+                     {"depth", job.depth},      {"nodes", job.nodes},
+                     {"random_plies", job.random_plies}, {"max_plies", job.max_plies},
+                     {"seed", job.seed}};
+        return c.sock.send_line(unit.dump());
+    }
+
+    // Отключает рабочего; невыполненная единица возвращается в начало очереди
+    void drop(const size_t i)
+    {
+        const long id = clients[i].unit;
+        if (id >= 0 && !done[size_t(id)])
+        {
+            pending.push_front(size_t(id));
+            ++requeued;
+        }
+        clients.erase(clients.begin() + long(i));
+    }
+
+    farm_job job;
+    TrainingWriter *writer;
+    LineSocket server;
+    vector<work_unit> units;
+    vector<bool> done;
+    size_t done_count = 0;
+    deque<size_t> pending;       // Невыданные единицы
+    vector<client> clients;
+};
@@ -0,0 +1,456 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+#include "../Models/Search.h"
+#include "Config.h"
+#include "Logic.h"
+#include "Notation.h"
+#include "Solver.h"
+
+using namespace std;
+
+// Позиции команды bench: начало партии, дебют, миттельшпиль, серии взятий, эндшпили с дамками
+// Менять набор можно только вместе с подписью (сумма nodes меняется)
+const vector<string> bench_fens = {
+    "W:Wa1,a3,b2,c1,c3,d2,e1,e3,f2,g1,g3,h2:Ba7,b6,b8,c7,d6,d8,e7,f6,f8,g7,h6,h8",
+    "W:Wa1,a3,b2,c1,d2,d4,e1,e3,f2,g1,g3,h2:Ba7,b6,b8,c7,d6,d8,e7,f8,g5,g7,h6,h8",
+    "W:Wa1,b2,c1,c3,d4,e1,e3,f2,g3,h2:Ba7,b6,b8,c7,d8,e5,e7,f8,g5,h6",
+    "B:Wa3,b2,c3,d2,e3,f2,f4,g1,h2:Ba5,b6,c7,d6,e7,f8,g7,h6",
+    "B:Wb2,c3,d4,e3,f4,g3,h4,Ke5:Ba5,b4,c5,d6,f6,g5,h6,Kb8",
+    "W:Wc3,e3,g3,a1,d2:Bb6,d6,f6,h8,a7",
+    "W:WKa1,Kc3,e1,g3,h2:BKh8,Kf6,b6,d8,a7",
+    "B:Wc3,e3,Kf2,g5:Bb4,d6,Kh8,a7",
+};
+const int bench_depth = 9;  // Уровень поиска команды bench по умолчанию
+
+// Фиксированные настройки бота для bench: подпись не зависит от settings.json и setoption
+// Материальная оценка, без кэшей, без случайности и без ограничения скорости
+inline void set_bench_config(Config &config)
+{
+    config.set("Bot", "BotScoringType", "NumberAndPotential");
+    config.set("Bot", "Optimization", "O1");
+    config.set("Bot", "AspirationWindow", 50);
+    config.set("Bot", "AspirationStats", false);
+    config.set("Bot", "BatchLeaves", true);
+    config.set("Bot", "EvalCacheMB", 0);
+    config.set("Bot", "EvalCacheShm", "");
+    config.set("Bot", "AnalysisCacheFile", "");
+    config.set("Bot", "NoRandom", true);
+    config.set("Bot", "NodesPerSecond", 0);
+}
+
+// Текстовый протокол движка через stdin/stdout (по образцу UCI) для внешних оболочек и турнирных программ
+// Команды:
+//   uci                                   - представиться, вывести опции, ответ uciok
+//   isready                               - ответ readyok
+//   setoption name <Name> value <Value>   - изменить настройку из раздела "Bot" (BotScoringType, NoRandom, Optimization,
+//                                           EvalCacheMB, EvalCacheShm, NodesPerSecond)
+//                                           или количество анализируемых лучших ходов (MultiPV)
+//   ucinewgame                            - начать новую партию
+//   position startpos|fen <FEN> [moves <m1> <m2> ...]
+//   go [depth N] [nodes N] [movetime MS] [wtime MS btime MS winc MS binc MS] [infinite] [ponder]
+//   stop, ponderhit, quit
+//   bench [depth N]                       - поиск на фиксированном наборе позиций (см. bench)
+//   solve [plies N] [nodes N] [hash MB]   - доказать выигрыш, проигрыш или ничью в текущей позиции (Game/Solver.h),
+//                                           ответ "info string solve win|loss|draw|unknown plies P nodes N time MS pv ..."
+// Во время поиска для каждого из MultiPV лучших ходов выводятся строки
+// "info multipv I depth D score cp|mate S nodes N nps X time MS pv <ход> <ответ> ...",
+// по окончании - "bestmove <ход> [ponder <ожидаемый ответ>]". Ходы записываются в нотации из Notation.h.
+class Engine
+{
+  public:
+    Engine() : logic(init_config(config))
+    {
+        parse_fen(start_fen, mtx, color);
+    }
+
+    // Главный цикл: читает команды до quit или конца входного потока
+    int run()
+    {
+        string line;
+        while (getline(cin, line))
+        {
+            if (!handle(line))
+                break;
+        }
+        stop_search();
+        return 0;
+    }
+
+    // Поиск на уровне depth в каждой позиции bench_fens с настройками set_bench_config и в одном потоке:
+    // каждая позиция ищется новым Logic, поэтому количество позиций зависит только от поведения поиска
+    // Сумма nodes - подпись поведения: при ускорении без изменения поиска она не меняется
+    // Возвращает сумму nodes
+    uint64_t bench(const int depth)
+    {
+        stop_search();
+        Config bench_config;
+        set_bench_config(bench_config);
+        search_limits limits;
+        limits.depth = depth;
+        uint64_t total_nodes = 0;
+        auto start = chrono::steady_clock::now();
+        for (size_t i = 0; i < bench_fens.size(); ++i)
+        {
+            vector<vector<POS_T>> bench_mtx;
+            bool bench_color;
+            parse_fen(bench_fens[i], bench_mtx, bench_color);
+            Logic bench_logic(&bench_config);
+            auto best = bench_logic.search(bench_mtx, bench_color, limits);
+            total_nodes += bench_logic.nodes;
+            send("info string bench " + to_string(i + 1) + "/" + to_string(bench_fens.size()) + " nodes " +
+                 to_string(bench_logic.nodes) + " bestmove " + (best.empty() ? string("none") : turns_to_string(best)));
+        }
+        const int time_ms = int(chrono::duration<double, milli>(chrono::steady_clock::now() - start).count());
+        send("Total time (ms): " + to_string(time_ms));
+        send("Nodes searched: " + to_string(total_nodes));
+        send("Nodes/second: " + to_string(total_nodes * 1000 / uint64_t(max(1, time_ms))));
+        return total_nodes;
+    }
+
+  private:
+    // Заполняет настройки, отсутствующие в settings.json, значениями по умолчанию
+    static Config *init_config(Config &config)
+    {
+        config.set_default("Bot", "BotScoringType", "NumberAndPotential");
+        config.set_default("Bot", "NoRandom", true);
+        config.set_default("Bot", "Optimization", "O1");
+        config.set_default("Bot", "EvalCacheMB", 0);
+        config.set_default("Bot", "EvalCacheShm", "");
+        config.set_default("Bot", "NodesPerSecond", 0);
+        return &config;
+    }
+
+    // Обрабатывает одну команду, возвращает false на quit
+    bool handle(const string &line)
+    {
+        stringstream ss(line);
+        string cmd;
+        if (!(ss >> cmd))
+            return true;
+        try
+        {
+            if (cmd == "uci")
+            {
+                send("id name Checkers");
+                send("id author izmailovilya");
+                send("option name BotScoringType type combo default " + string(config("Bot", "BotScoringType")) +
+                     " var NumberOnly var NumberAndPotential var Weights var Nnue");
+                send("option name NoRandom type check default " + string(config("Bot", "NoRandom") ? "true" : "false"));
+                send("option name Optimization type combo default " + string(config("Bot", "Optimization")) +
+                     " var O0 var O1");
+                send("option name EvalCacheMB type spin default " + to_string(int(config("Bot", "EvalCacheMB"))) +
+                     " min 0 max 4096");
+                send("option name EvalCacheShm type string default " + string(config("Bot", "EvalCacheShm")));
+                send("option name NodesPerSecond type spin default " + to_string(int64_t(config("Bot", "NodesPerSecond"))) +
+                     " min 0 max 1000000000");
+                send("option name MultiPV type spin default 1 min 1 max 64");
+                send("uciok");
+            }
+            else if (cmd == "isready")
+            {
+                send("readyok");
+            }
+            else if (cmd == "setoption")
+            {
+                stop_search();
+                set_option(ss);
+            }
+            else if (cmd == "ucinewgame")
+            {
+                stop_search();
+                logic = Logic(&config);
+                parse_fen(start_fen, mtx, color);
+            }
+            else if (cmd == "position")
+            {
+                stop_search();
+                set_position(ss);
+            }
+            else if (cmd == "go")
+            {
+                stop_search();
+                go(ss);
+            }
+            else if (cmd == "stop")
+            {
+                stop_search();
+            }
+            else if (cmd == "ponderhit")
+            {
+                ponderhit();
+            }
+            else if (cmd == "bench")
+            {
+                string token;
+                int depth = bench_depth;
+                if (ss >> token && token == "depth")
+                    ss >> depth;
+                bench(depth);
+            }
+            else if (cmd == "solve")
+            {
+                stop_search();
+                solve(ss);
+            }
+            else if (cmd == "quit")
+            {
+                return false;
+            }
+            else
+            {
+                send("info string unknown command '" + cmd + "'");
+            }
+        }
+        catch (const exception &e)
+        {
+            send(string("info string error: ") + e.what());
+        }
+        return true;
+    }
+
+    // setoption name <Name> value <Value>
+    void set_option(stringstream &ss)
+    {
+        string token, name, value;
+        ss >> token >> name >> token >> value;
+        if (name == "MultiPV")
+        {
+            multi_pv = size_t(max(1, stoi(value)));
+            return;
+        }
+        if (name == "NoRandom")
+            config.set("Bot", name, value == "true");
+        else if (name == "EvalCacheMB")
+            config.set("Bot", name, max(0, stoi(value)));
+        else if (name == "NodesPerSecond")
+            config.set("Bot", name, max(int64_t(0), int64_t(stoll(value))));
+        else if (name == "BotScoringType" || name == "Optimization" || name == "EvalCacheShm")
+            config.set("Bot", name, value);
+        else
+            throw runtime_error("unknown option '" + name + "'");
+        logic = Logic(&config);
+    }
+
+    // position startpos|fen <FEN> [moves ...]
+    void set_position(stringstream &ss)
+    {
+        string token, fen;
+        ss >> token;
+        if (token == "startpos")
+        {
+            fen = start_fen;
+            ss >> token;
+        }
+        else if (token == "fen")
+        {
+            while (ss >> token && token != "moves")
+                fen += token;
+        }
+        else
+            throw runtime_error("startpos or fen expected");
+
+        vector<vector<POS_T>> new_mtx;
+        bool new_color;
+        parse_fen(fen, new_mtx, new_color);
+        if (token == "moves")
+        {
+            while (ss >> token)
+            {
+                for (auto turn : parse_turns(new_mtx, new_color, token))
+                    new_mtx = logic.make_turn(new_mtx, turn);
+                new_color = !new_color;
+            }
+        }
+        mtx = new_mtx;
+        color = new_color;
+    }
+
+    // go [depth N] [nodes N] [movetime MS] [wtime MS btime MS winc MS binc MS] [infinite] [ponder]
+    void go(stringstream &ss)
+    {
+        search_limits limits;
+        int time_left[2] = {-1, -1}, inc[2] = {0, 0};
+        bool ponder = false;
+        string token;
+        while (ss >> token)
+        {
+            if (token == "depth")
+                ss >> limits.depth;
+            else if (token == "nodes")
+                ss >> limits.nodes;
+            else if (token == "movetime")
+                ss >> limits.movetime_ms;
+            else if (token == "wtime")
+                ss >> time_left[0];
+            else if (token == "btime")
+                ss >> time_left[1];
+            else if (token == "winc")
+                ss >> inc[0];
+            else if (token == "binc")
+                ss >> inc[1];
+            else if (token == "infinite")
+                limits.infinite = true;
+            else if (token == "ponder")
+                ponder = true;
+        }
+        // Контроль времени на партию: тратим примерно 1/20 оставшегося времени и прибавку
+        if (limits.movetime_ms < 0 && time_left[color] >= 0)
+            limits.movetime_ms = max(1, time_left[color] / 20 + inc[color] / 2);
+        // Без ограничений ищем до уровня бота по умолчанию
+        if (limits.depth < 0 && limits.nodes < 0 && limits.movetime_ms < 0 && !limits.infinite && !ponder)
+            limits.depth = 5;
+
+        // При размышлении на времени соперника время не ограничиваем до ponderhit
+        pondering = ponder || limits.infinite;
+        ponder_limits = limits;
+        if (ponder)
+        {
+            limits.movetime_ms = -1;
+            limits.infinite = (limits.depth < 0 && limits.nodes < 0);
+        }
+        stop = false;
+        searcher = thread(&Engine::search_thread, this, limits);
+    }
+
+    // solve [plies N] [nodes N] [hash MB]: по умолчанию 60 полуходов, 10 млн позиций, таблица 64 Мб
+    void solve(stringstream &ss)
+    {
+        int plies = 60;
+        uint64_t max_nodes = 10000000;
+        size_t hash_mb = 64;
+        string token;
+        while (ss >> token)
+        {
+            if (token == "plies")
+                ss >> plies;
+            else if (token == "nodes")
+                ss >> max_nodes;
+            else if (token == "hash")
+                ss >> hash_mb;
+        }
+        Solver solver(hash_mb);
+        auto info = solver.solve(mtx, color, plies, max_nodes);
+        const string results[] = {"win", "loss", "draw", "unknown"};
+        stringstream out;
+        out << "info string solve " << results[int(info.result)] << " plies " << info.plies << " nodes " << info.nodes
+            << " time " << info.time_ms;
+        if (!info.line.empty())
+            out << " pv " << pv_to_string(info.line);
+        send(out.str());
+    }
+
+    // Поток поиска: итеративное углубление с выводом info и bestmove в конце
+    void search_thread(const search_limits limits)
+    {
+        logic.stop_flag = &stop;
+        logic.multi_pv = multi_pv;
+        vector<move_pos> best_pv;
+        auto best = logic.search(mtx, color, limits, [this, &best_pv](const search_info &info) {
+            for (size_t i = 0; i < info.lines.size(); ++i)
+            {
+                stringstream out;
+                out << "info multipv " << i + 1 << " depth " << info.depth << " score " << score_to_string(info.lines[i].score)
+                    << " nodes " << info.nodes << " nps " << (info.nodes * 1000 / max(1, info.time_ms)) << " time "
+                    << info.time_ms << " pv " << pv_to_string(info.lines[i].pv);
+                send(out.str());
+            }
+            best_pv = info.pv;
+        });
+        logic.stop_flag = nullptr;
+        if (logic.cache_probes)
+            send("info string eval cache hits " + to_string(logic.cache_hits * 100 / logic.cache_probes) + "% (" +
+                 to_string(logic.cache_hits) + " of " + to_string(logic.cache_probes) + ")");
+        // Поиск не успел выбрать ход: отдаем первый допустимый
+        if (best.empty())
+            best = first_series(mtx, color);
+        // В режимах infinite и ponder bestmove выводится только после stop или ponderhit
+        {
+            unique_lock<mutex> lock(state_mtx);
+            state_cv.wait(lock, [this] { return !pondering || stop; });
+        }
+        // Ожидаемый ответ соперника - второй полуход главного варианта
+        auto plies = split_pv(best_pv);
+        if (plies.size() > 1 && plies[0] == best)
+            send("bestmove " + turns_to_string(best) + " ponder " + turns_to_string(plies[1]));
+        else
+            send("bestmove " + turns_to_string(best));
+    }
+
+    // Возвращает первую допустимую серию ходов (нужна, если поиск прерван сразу после старта)
+    vector<move_pos> first_series(const vector<vector<POS_T>> &cur_mtx, const bool cur_color)
+    {
+        vector<move_pos> res;
+        move_list moves;
+        Logic::find_moves(cur_color, cur_mtx, moves);
+        if (!moves.empty())
+            moves[0].to_turns(res);
+        return res;
+    }
+
+    // Соперник сделал ожидаемый ход: продолжаем поиск уже с обычным ограничением по времени
+    void ponderhit()
+    {
+        if (!searcher.joinable())
+            return;
+        const int movetime = ponder_limits.movetime_ms;
+        {
+            lock_guard<mutex> lock(state_mtx);
+            pondering = ponder_limits.infinite;
+        }
+        state_cv.notify_all();
+        if (movetime >= 0 && !ponder_limits.infinite)
+        {
+            // Таймер останавливает поиск по истечении времени на ход
+            if (timer.joinable())
+                timer.join();
+            timer = thread([this, movetime] {
+                unique_lock<mutex> lock(state_mtx);
+                state_cv.wait_for(lock, chrono::milliseconds(movetime), [this] { return bool(stop); });
+                stop = true;
+            });
+        }
+    }
+
+    // Останавливает текущий поиск и дожидается вывода bestmove
+    void stop_search()
+    {
+        {
+            lock_guard<mutex> lock(state_mtx);
+            stop = true;
+        }
+        state_cv.notify_all();
+        if (searcher.joinable())
+            searcher.join();
+        if (timer.joinable())
+            timer.join();
+    }
+
+    // Потокобезопасный вывод строки протокола
+    void send(const string &line)
+    {
+        lock_guard<mutex> lock(out_mtx);
+        cout << line << endl;
+    }
+
+  private:
+    Config config;
+    Logic logic;
+    vector<vector<POS_T>> mtx;    // Текущая позиция
+    bool color = false;           // Очередь хода в текущей позиции
+    thread searcher;              // Поток поиска
+    thread timer;                 // Таймер, останавливающий поиск после ponderhit
+    atomic<bool> stop{false};     // Флаг остановки поиска
+    bool pondering = false;       // Поиск без ограничений: bestmove выводится только после stop/ponderhit
+    search_limits ponder_limits;  // Ограничения, которые вступят в силу после ponderhit
+    size_t multi_pv = 1;          // Сколько лучших ходов анализировать (опция MultiPV)
+    mutex out_mtx;                // Защищает stdout
+    mutex state_mtx;              // Защищает pondering и ожидание таймера
+    condition_variable state_cv;
+};
@@ -0,0 +1,189 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#ifndef _WIN32
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+using namespace std;
+
+// Кэш оценок листьев по хешу позиции (Zobrist, с учетом очереди хода)
+// Запись - одно 64-битное слово: старшие 32 бита хеша и оценка, поэтому чтение и запись атомарны без блокировок,
+// и кэш можно делить между потоками. Кэш с потерями: новая запись вытесняет старую с тем же индексом,
+// совпадение старших битов у разных позиций (вероятность 2^-32) дает чужую оценку
+// Таблица может лежать в именованном сегменте общей памяти POSIX (EvalCacheShm): тогда ее делят все процессы
+// движка на машине, и анализ в новом процессе начинается с оценок, найденных предыдущими
+class EvalCache
+{
+  public:
+    // Параметр megabytes: размер таблицы (округляется вниз до степени двойки записей)
+    // Параметр shm_name: имя сегмента общей памяти ("/checkers_eval"), пустое - таблица только этого процесса.
+    // Если сегмент уже создан, размер берется из него. Сегмент живет до перезагрузки или удаления (shm_unlink)
+    // Параметр salt: смешивается с ключами, чтобы процессы с разными оценками не видели записи друг друга
+    explicit EvalCache(const size_t megabytes, const string &shm_name = "", const uint64_t salt = 0) : salt(salt)
+    {
+        size_t count = 1;
+        while (count * 2 * sizeof(uint64_t) <= megabytes * 1024 * 1024)
+            count *= 2;
+        if (!shm_name.empty())
+        {
+            attach(shm_name, count);
+            return;
+        }
+        local = make_unique<atomic<uint64_t>[]>(count);
+        table = local.get();
+        mask = count - 1;
+        clear();
+    }
+
+    EvalCache(const EvalCache &) = delete;
+    EvalCache &operator=(const EvalCache &) = delete;
+
+    ~EvalCache()
+    {
+#ifndef _WIN32
+        if (mapping)
+            munmap(mapping, mapping_size);
+#endif
+    }
+
+    // Ищет оценку позиции с хешем key; возвращает false, если ее нет
+    bool probe(uint64_t key, int &score) const
+    {
+        key ^= salt;
+        const uint64_t entry = table[key & mask].load(memory_order_relaxed);
+        if ((entry ^ key) >> 32)
+            return false;
+        score = int32_t(uint32_t(entry));
+        return true;
+    }
+
+    void store(uint64_t key, const int score)
+    {
+        key ^= salt;
+        table[key & mask].store((key & 0xFFFFFFFF00000000ull) | uint32_t(int32_t(score)), memory_order_relaxed);
+    }
+
+    void clear()
+    {
+        for (size_t i = 0; i <= mask; ++i)
+            table[i].store(0, memory_order_relaxed);
+    }
+
+    // Количество записей
+    size_t size() const
+    {
+        return mask + 1;
+    }
+
+    // Таблица в общей памяти
+    bool shared() const
+    {
+        return mapping != nullptr;
+    }
+
+    // Соль из описания оценки (FNV-1a): одинаковые описания дают одинаковую соль в любом процессе
+    static uint64_t salt_of(const string &text)
+    {
+        uint64_t res = 14695981039346656037ull;
+        for (const char c : text)
+            res = (res ^ uint8_t(c)) * 1099511628211ull;
+        return res;
+    }
+
+  private:
+    // Заголовок сегмента общей памяти, за ним - записи
+    struct shm_header
+    {
+        atomic<uint64_t> magic;  // shm_magic, когда сегмент готов
+        uint64_t count;          // Количество записей
+    };
+
+    static constexpr uint64_t shm_magic = 0x31484345484b4300ull;  // "\0CKHECH1"
+
+    // Создает сегмент или подключается к существующему; бросает runtime_error при ошибке
+    void attach(const string &name, const size_t count)
+    {
+#ifdef _WIN32
+        throw runtime_error("shared memory eval cache is not supported on Windows");
+#else
+        static_assert(sizeof(shm_header) % sizeof(uint64_t) == 0 && atomic<uint64_t>::is_always_lock_free,
+                      "entries must be lock-free across processes");
+        int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+        const bool created = (fd >= 0);
+        if (!created)
+            fd = shm_open(name.c_str(), O_RDWR, 0600);
+        if (fd < 0)
+            throw runtime_error("can't open shared memory " + name);
+        size_t entries = count;
+        if (created)
+        {
+            // Новый сегмент заполнен нулями: записи пусты, остается записать заголовок
+            if (ftruncate(fd, off_t(sizeof(shm_header) + count * sizeof(uint64_t))) != 0)
+            {
+                close(fd);
+                shm_unlink(name.c_str());
+                throw runtime_error("can't allocate shared memory " + name);
+            }
+        }
+        else
+        {
+            // Создатель мог еще не записать заголовок: ждем его до секунды
+            for (int i = 0; i < 1000; ++i)
+            {
+                struct stat st;
+                if (fstat(fd, &st) == 0 && size_t(st.st_size) > sizeof(shm_header))
+                {
+                    entries = (size_t(st.st_size) - sizeof(shm_header)) / sizeof(uint64_t);
+                    break;
+                }
+                usleep(1000);
+            }
+        }
+        mapping_size = sizeof(shm_header) + entries * sizeof(uint64_t);
+        void *ptr = mmap(nullptr, mapping_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (ptr == MAP_FAILED)
+            throw runtime_error("can't map shared memory " + name);
+        mapping = ptr;
+    #ifdef MADV_HUGEPAGE
+        // Большие страницы снижают промахи TLB на большой таблице (если ядро разрешает их для общей памяти)
+        madvise(ptr, mapping_size, MADV_HUGEPAGE);
+    #endif
+        shm_header *header = static_cast<shm_header *>(ptr);
+        if (created)
+        {
+            header->count = count;
+            header->magic.store(shm_magic, memory_order_release);
+        }
+        else
+        {
+            for (int i = 0; i < 1000 && header->magic.load(memory_order_acquire) != shm_magic; ++i)
+                usleep(1000);
+            if (header->magic.load(memory_order_acquire) != shm_magic || header->count != entries ||
+                (entries & (entries - 1)))
+            {
+                munmap(ptr, mapping_size);
+                mapping = nullptr;
+                throw runtime_error("shared memory " + name + " is not an eval cache");
+            }
+        }
+        table = reinterpret_cast<atomic<uint64_t> *>(header + 1);
+        mask = entries - 1;
+#endif
+    }
+
+    unique_ptr<atomic<uint64_t>[]> local;  // Таблица этого процесса (без общей памяти)
+    atomic<uint64_t> *table = nullptr;
+    size_t mask = 0;
+    uint64_t salt;
+    void *mapping = nullptr;  // Отображение сегмента общей памяти
+    size_t mapping_size = 0;
+};
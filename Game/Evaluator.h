@@ -0,0 +1,321 @@
+#pragma once
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <nlohmann/json.hpp>
+
+#include "../Models/Move.h"
+#include "../Models/Weights.h"
+
+using namespace std;
+
+// Оценочная функция с настраиваемыми весами (BotScoringType = "Weights")
+// Оценка линейна по весам и интерполируется между началом партии и эндшпилем по фазе.
+// Слагаемые, зависящие только от фигуры и ее поля (материал, продвижение, первый ряд, центр), хранятся
+// в накопителе eval_acc и обновляются по ходу; подвижность, проходные шашки и право хода считаются в листе.
+class Evaluator
+{
+  public:
+    Evaluator()
+    {
+        build();
+    }
+
+    // Загружает веса из файла: JSON (расширение .json) или двоичный формат (см. save)
+    // Признаки, отсутствующие в файле, сохраняют прежние веса; бросает runtime_error при ошибке
+    void load(const string &path)
+    {
+        ifstream fin(path, ios::binary);
+        if (!fin.is_open())
+            throw runtime_error("can't open " + path);
+        if (is_json(path))
+        {
+            nlohmann::json data;
+            try
+            {
+                fin >> data;
+            }
+            catch (const exception &e)
+            {
+                throw runtime_error("bad weights file " + path + ": " + e.what());
+            }
+            for (int t = 0; t < TERMS_COUNT; ++t)
+            {
+                if (!data.contains(eval_term_names[t]))
+                    continue;
+                auto &w = data[eval_term_names[t]];
+                if (!w.is_array() || w.size() != 2 || !w[0].is_number() || !w[1].is_number())
+                    throw runtime_error("bad weights file " + path + ": [mg, eg] expected for " + eval_term_names[t]);
+                weights.mg[t] = w[0];
+                weights.eg[t] = w[1];
+            }
+        }
+        else
+        {
+            // Двоичный формат: "CKW1", количество признаков (1 байт), затем пары int16 (mg, eg) в порядке eval_term
+            char magic[4];
+            uint8_t count = 0;
+            if (!fin.read(magic, 4) || memcmp(magic, "CKW1", 4) != 0 || !fin.read(reinterpret_cast<char *>(&count), 1))
+                throw runtime_error("bad weights file " + path);
+            for (int t = 0; t < count; ++t)
+            {
+                int16_t w[2];
+                if (!fin.read(reinterpret_cast<char *>(w), sizeof(w)))
+                    throw runtime_error("bad weights file " + path + ": unexpected end");
+                if (t < TERMS_COUNT)
+                {
+                    weights.mg[t] = w[0];
+                    weights.eg[t] = w[1];
+                }
+            }
+        }
+        build();
+    }
+
+    // Сохраняет веса в файл (формат по расширению, как в load)
+    void save(const string &path) const
+    {
+        ofstream fout(path, ios::binary | ios::trunc);
+        if (!fout.is_open())
+            throw runtime_error("can't open " + path);
+        if (is_json(path))
+        {
+            // Один признак в строке: "Name": [mg, eg]
+            fout << "{\n";
+            for (int t = 0; t < TERMS_COUNT; ++t)
+                fout << "    \"" << eval_term_names[t] << "\": [" << weights.mg[t] << ", " << weights.eg[t] << "]"
+                     << (t + 1 < TERMS_COUNT ? "," : "") << "\n";
+            fout << "}\n";
+            return;
+        }
+        const uint8_t count = TERMS_COUNT;
+        fout.write("CKW1", 4);
+        fout.write(reinterpret_cast<const char *>(&count), 1);
+        for (int t = 0; t < TERMS_COUNT; ++t)
+        {
+            const int16_t w[2] = {int16_t(weights.mg[t]), int16_t(weights.eg[t])};
+            fout.write(reinterpret_cast<const char *>(w), sizeof(w));
+        }
+    }
+
+    // Меняет веса и пересчитывает таблицы
+    void set_weights(const eval_weights &new_weights)
+    {
+        weights = new_weights;
+        build();
+    }
+
+    const eval_weights &get_weights() const
+    {
+        return weights;
+    }
+
+    // Вклад фигуры type на поле x, y в оценку с точки зрения белых при фазе phase (без признаков всей доски)
+    int piece_score(const POS_T type, const POS_T x, const POS_T y, const int phase) const
+    {
+        return (pst_mg[type][x * 8 + y] * phase + pst_eg[type][x * 8 + y] * (PHASE_MAX - phase)) / PHASE_MAX;
+    }
+
+    // Накопитель для позиции, посчитанный с нуля
+    template <class Matrix> eval_acc init(const Matrix &mtx) const
+    {
+        eval_acc acc;
+        for (POS_T i = 0; i < 8; ++i)
+        {
+            for (POS_T j = 0; j < 8; ++j)
+            {
+                if (mtx[i][j])
+                    add(acc, mtx[i][j], i, j);
+            }
+        }
+        return acc;
+    }
+
+    // Обновляет накопитель позиции mtx на ход move (mtx - позиция до хода)
+    template <class Matrix> void update(eval_acc &acc, const Matrix &mtx, const full_move &move) const
+    {
+        const POS_T type = mtx[move.x][move.y];
+        remove(acc, type, move.x, move.y);
+        for (uint8_t i = 0; i < move.size; ++i)
+        {
+            const POS_T xb = POS_T(move.beat_path[i] / 8), yb = POS_T(move.beat_path[i] % 8);
+            remove(acc, mtx[xb][yb], xb, yb);
+        }
+        add(acc, POS_T(type + (move.is_promotion ? 2 : 0)), move.x2, move.y2);
+    }
+
+    // Оценка позиции с точки зрения color по накопителю acc
+    // У обеих сторон должны быть фигуры (окончание партии проверяет вызывающий)
+    template <class Matrix> int evaluate(const Matrix &mtx, const eval_acc &acc, const bool color) const
+    {
+        int f[TERMS_COUNT] = {};
+        leaf_features(mtx, acc, color, f);
+        int mg = acc.mg, eg = acc.eg;
+        for (int t = TERM_TEMPO; t < TERMS_COUNT; ++t)
+        {
+            mg += weights.mg[t] * f[t];
+            eg += weights.eg[t] * f[t];
+        }
+        const int phase = min(acc.phase, PHASE_MAX);
+        const int score = (mg * phase + eg * (PHASE_MAX - phase)) / PHASE_MAX;
+        return color ? -score : score;
+    }
+
+    // Все признаки позиции (разность белых и черных) и ее фаза - для подбора весов
+    // Оценка с точки зрения белых равна сумме (mg[t] * phase + eg[t] * (PHASE_MAX - phase)) * f[t] / PHASE_MAX
+    template <class Matrix> static void features(const Matrix &mtx, const bool color, int f[TERMS_COUNT], int &phase)
+    {
+        eval_acc acc;
+        fill(f, f + TERMS_COUNT, 0);
+        for (POS_T i = 0; i < 8; ++i)
+        {
+            for (POS_T j = 0; j < 8; ++j)
+            {
+                const POS_T type = mtx[i][j];
+                if (!type)
+                    continue;
+                ++acc.count[type];
+                acc.phase += (type > 2 ? 2 : 1);
+                const int sign = (type % 2 ? 1 : -1);
+                if (type > 2)
+                    f[TERM_KING] += sign;
+                else
+                {
+                    f[TERM_MAN] += sign;
+                    f[TERM_ADVANCE] += sign * advance(type, i);
+                    f[TERM_BACK_RANK] += sign * (advance(type, i) == 0);
+                }
+                f[TERM_CENTER] += sign * is_center(i, j);
+            }
+        }
+        leaf_features(mtx, acc, color, f);
+        phase = min(acc.phase, PHASE_MAX);
+    }
+
+  private:
+    // Сколько рядов прошла шашка type, стоящая в ряду x
+    static int advance(const POS_T type, const POS_T x)
+    {
+        return type == 1 ? 7 - x : x;
+    }
+
+    // Центральные поля: ряды и столбцы 3-6 (c3-f6)
+    static bool is_center(const POS_T x, const POS_T y)
+    {
+        return x >= 2 && x <= 5 && y >= 2 && y <= 5;
+    }
+
+    static bool is_json(const string &path)
+    {
+        return path.size() >= 5 && path.compare(path.size() - 5, 5, ".json") == 0;
+    }
+
+    // Признаки, которые считаются по всей доске: право хода, подвижность, проходные шашки, дамки против шашек
+    template <class Matrix> static void leaf_features(const Matrix &mtx, const eval_acc &acc, const bool color, int f[TERMS_COUNT])
+    {
+        int mobility = 0, runaway = 0;
+        for (POS_T i = 0; i < 8; ++i)
+        {
+            for (POS_T j = (i + 1) % 2; j < 8; j += 2)
+            {
+                const POS_T type = mtx[i][j];
+                if (!type)
+                    continue;
+                const int sign = (type % 2 ? 1 : -1);
+                if (type <= 2)
+                {
+                    const POS_T i2 = (type == 1 ? i - 1 : i + 1);
+                    if (i2 < 0 || i2 > 7)
+                        continue;
+                    mobility += sign * ((j > 0 && !mtx[i2][j - 1]) + (j < 7 && !mtx[i2][j + 1]));
+                    runaway += sign * is_runaway(mtx, type, i, j);
+                    continue;
+                }
+                for (POS_T di = -1; di <= 1; di += 2)
+                {
+                    for (POS_T dj = -1; dj <= 1; dj += 2)
+                    {
+                        for (POS_T i2 = i + di, j2 = j + dj; i2 >= 0 && i2 < 8 && j2 >= 0 && j2 < 8 && !mtx[i2][j2];
+                             i2 += di, j2 += dj)
+                            mobility += sign;
+                    }
+                }
+            }
+        }
+        f[TERM_TEMPO] = (color ? -1 : 1);
+        f[TERM_MOBILITY] = mobility;
+        f[TERM_RUNAWAY] = runaway;
+        f[TERM_KING_VS_MEN] = int(acc.count[3] && !acc.count[4]) - int(acc.count[4] && !acc.count[3]);
+    }
+
+    // Проходная шашка: не дальше 3 рядов от превращения, и в конусе перед ней нет фигур противника
+    template <class Matrix> static bool is_runaway(const Matrix &mtx, const POS_T type, const POS_T x, const POS_T y)
+    {
+        const int dir = (type == 1 ? -1 : 1);
+        const int rows = (type == 1 ? x : 7 - x);
+        if (rows > 3)
+            return false;
+        for (int r = 1; r <= rows; ++r)
+        {
+            const int i = x + dir * r;
+            for (int j = max(0, y - r); j <= min(7, y + r); ++j)
+            {
+                if (mtx[i][j] && mtx[i][j] % 2 != type % 2)
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    void add(eval_acc &acc, const POS_T type, const POS_T x, const POS_T y) const
+    {
+        acc.mg += pst_mg[type][x * 8 + y];
+        acc.eg += pst_eg[type][x * 8 + y];
+        acc.phase += (type > 2 ? 2 : 1);
+        ++acc.count[type];
+    }
+
+    void remove(eval_acc &acc, const POS_T type, const POS_T x, const POS_T y) const
+    {
+        acc.mg -= pst_mg[type][x * 8 + y];
+        acc.eg -= pst_eg[type][x * 8 + y];
+        acc.phase -= (type > 2 ? 2 : 1);
+        --acc.count[type];
+    }
+
+    // Пересчитывает таблицы "фигура-поле" по весам (черные - с обратным знаком)
+    void build()
+    {
+        for (POS_T type = 1; type <= 4; ++type)
+        {
+            const int sign = (type % 2 ? 1 : -1);
+            for (POS_T x = 0; x < 8; ++x)
+            {
+                for (POS_T y = 0; y < 8; ++y)
+                {
+                    int mg = weights.mg[TERM_CENTER] * is_center(x, y), eg = weights.eg[TERM_CENTER] * is_center(x, y);
+                    if (type > 2)
+                    {
+                        mg += weights.mg[TERM_KING];
+                        eg += weights.eg[TERM_KING];
+                    }
+                    else
+                    {
+                        const int rows = advance(type, x);
+                        mg += weights.mg[TERM_MAN] + weights.mg[TERM_ADVANCE] * rows + weights.mg[TERM_BACK_RANK] * (rows == 0);
+                        eg += weights.eg[TERM_MAN] + weights.eg[TERM_ADVANCE] * rows + weights.eg[TERM_BACK_RANK] * (rows == 0);
+                    }
+                    pst_mg[type][x * 8 + y] = sign * mg;
+                    pst_eg[type][x * 8 + y] = sign * eg;
+                }
+            }
+        }
+    }
+
+  private:
+    eval_weights weights;
+    int pst_mg[5][64] = {};  // Вклад фигуры type на поле x * 8 + y в начале партии (с точки зрения белых)
+    int pst_eg[5][64] = {};  // То же в эндшпиле
+};
@@ -1,8 +1,10 @@
 #pragma once
 #include <chrono>
+#include <future>
 #include <thread>
 #include <fstream>
 
+#include "../Models/GameState.h"
 #include "../Models/Project_path.h"
 #include "../Models/Response.h"
 #include "../Models/Move.h"
@@ -10,323 +12,581 @@
 #include "Config.h"
 #include "Hand.h"
 #include "Logic.h"
+#include "Mcts.h"
+#include "Pdn.h"
 
 using namespace std;
 
 class Game
 {
   public:
-    Game() : board(config("WindowSize", "Width"), config("WindowSize", "Hight")), hand(&board), logic(&board, &config)
+    Game() : board(config("WindowSize", "Width"), config("WindowSize", "Hight")), hand(&board), logic(new_log(config))
     {
-        ofstream fout(project_path + "log.txt", ios_base::trunc);
-        fout.close();
     }
 
     // Главная функция игры - запускает игровой цикл шашек
     // Возвращает результат игры: 0 - ничья, 1 - победа белых, 2 - победа черных
+    // Цикл по шагам автомата (см. step) без рекурсии: повтор игры - переход в начальное состояние,
+    // поэтому стек не растет при любом количестве повторов
     int play()
     {
-        // Засекаем время начала игры для статистики
-        auto start = chrono::steady_clock::now();
-        
-        // Обработка режима повтора игры
-        if (is_replay)
-        {
-            logic = Logic(&board, &config);  // Пересоздаем логику игры
-            config.reload();                 // Перезагружаем конфигурацию
-            board.redraw();                  // Перерисовываем доску
-        }
-        else
+        while (step())
+            idle();
+        return result;
+    }
+
+    // Один шаг автомата партии: не больше одного события ввода, один ход бота из серии, запуск или конец партии
+    // Не блокируется: ввод опрашивается без ожидания, бот ищет ход в отдельном потоке, задержки - по часам.
+    // Поэтому один поток может по очереди выполнять шаги нескольких партий
+    // Возвращает false, когда игра окончена (результат - в result)
+    bool step()
+    {
+        switch (state)
         {
-            board.start_draw();              // Первоначальная отрисовка доски
+        case GameState::START:
+            start_game();
+            break;
+        case GameState::NEXT_TURN:
+            next_turn();
+            break;
+        case GameState::PLAYER:
+            player_step();
+            break;
+        case GameState::BOT_THINK:
+            bot_think_step();
+            break;
+        case GameState::BOT_MOVE:
+            bot_move_step();
+            break;
+        case GameState::FINISH:
+            finish_game();
+            break;
+        case GameState::FINAL:
+            final_step();
+            break;
+        case GameState::DONE:
+            break;
         }
-        is_replay = false;
+        return state != GameState::DONE;
+    }
+
+    // Текущее состояние автомата
+    GameState get_state() const
+    {
+        return state;
+    }
+
+    int result = 0;  // Результат последней партии (см. play)
+
+  private:
+    // Очищает log.txt до создания бота, чтобы в журнале остались ошибки загрузки его настроек
+    static Config *new_log(Config &config)
+    {
+        ofstream fout(project_path + "log.txt", ios_base::trunc);
+        fout.close();
+        return &config;
+    }
 
-        // Инициализация игрового цикла
-        int turn_num = -1;                   // Счетчик ходов (-1, чтобы первый ход был 0)
-        bool is_quit = false;                // Флаг выхода из игры
-        const int Max_turns = config("Game", "MaxNumTurns");  // Максимальное количество ходов
-        
-        // Основной игровой цикл
-        while (++turn_num < Max_turns)
+    // Загружает последнюю партию из файла LoadPDN и повторяет ее ходы на доске
+    // Возвращает количество сделанных полуходов (с учетом того, что первыми могли ходить черные)
+    // При ошибке пишет ее в log.txt и оставляет начальную позицию
+    int load_pdn()
+    {
+        first_color = false;
+        auto path = config("Game", "LoadPDN");
+        if (!path.is_string() || string(path).empty())
+            return 0;
+        try
         {
-            beat_series = 0;                 // Сброс счетчика серии взятий
-            
-            // Определяем возможные ходы для текущего игрока (turn_num % 2: 0=белые, 1=черные)
-            logic.find_turns(turn_num % 2);
-            
-            // Если нет доступных ходов - игра окончена
-            if (logic.turns.empty())
-                break;
-            
-            // Устанавливаем глубину поиска для бота в зависимости от цвета
-            logic.Max_depth = config("Bot", string((turn_num % 2) ? "Black" : "White") + string("BotLevel"));
-            
-            // Проверяем, играет ли человек или бот за текущий цвет
-            if (!config("Bot", string("Is") + string((turn_num % 2) ? "Black" : "White") + string("Bot")))
+            PdnReader reader(project_path + string(path));
+            pdn_game game, last;
+            while (reader.next(game))
+                last = game;
+            vector<vector<POS_T>> mtx;
+            auto turns = pdn_to_turns(last, mtx, first_color);
+            board.set_start_board(mtx);
+            for (auto &series : turns)
             {
-                // Ход человека
-                auto resp = player_turn(turn_num % 2);
-                
-                // Обработка ответа игрока
-                if (resp == Response::QUIT)
-                {
-                    is_quit = true;
-                    break;
-                }
-                else if (resp == Response::REPLAY)
-                {
-                    is_replay = true;
-                    break;
-                }
-                else if (resp == Response::BACK)  // Откат хода назад
+                int beat_num = 0;
+                for (auto turn : series)
                 {
-                    // Если предыдущий ход делал бот и это не серия взятий
-                    if (config("Bot", string("Is") + string((1 - turn_num % 2) ? "Black" : "White") + string("Bot")) &&
-                        !beat_series && board.history_mtx.size() > 2)
-                    {
-                        board.rollback();    // Откатываем ход бота
-                        --turn_num;
-                    }
-                    if (!beat_series)
-                        --turn_num;
-                    
-                    board.rollback();        // Откатываем ход игрока
-                    --turn_num;
-                    beat_series = 0;
+                    beat_num += (turn.xb != -1);
+                    board.move_piece(turn, beat_num);
                 }
             }
-            else
-            {
-                // Ход бота
-                bot_turn(turn_num % 2);
-            }
+            return int(turns.size()) + first_color;
         }
-        
-        // Записываем время игры в лог
-        auto end = chrono::steady_clock::now();
-        ofstream fout(project_path + "log.txt", ios_base::app);
-        fout << "Game time: " << (int)chrono::duration<double, milli>(end - start).count() << " millisec\n";
+        catch (const exception &e)
+        {
+            ofstream fout(project_path + "log.txt", ios_base::app);
+            fout << "Error: can't load PDN: " << e.what() << "\n";
+            fout.close();
+            board.redraw();
+            first_color = false;
+            return 0;
+        }
+    }
+
+    // Дописывает сыгранную партию в файл SavePDN (если настройка задана)
+    // Параметр result: результат в нотации PDN ("2-0", "0-2", "1-1" или "*")
+    void save_pdn(const string &result)
+    {
+        auto path = config("Game", "SavePDN");
+        auto turns = board.get_history_turns();
+        if (!path.is_string() || string(path).empty() || turns.empty())
+            return;
+
+        // Дата партии в формате PDN (ГГГГ.ММ.ДД)
+        time_t now = time(nullptr);
+        char date[16];
+        strftime(date, sizeof(date), "%Y.%m.%d", localtime(&now));
+
+        auto player_name = [this](const string &color) {
+            if (!config("Bot", "Is" + color + "Bot"))
+                return string("Human");
+            if (config("Bot", "BotType").is_string() && string(config("Bot", "BotType")) == "Mcts")
+                return string("Bot MCTS");
+            if (bot_nodes(color) > 0)
+                return "Bot " + to_string(bot_nodes(color)) + " nodes";
+            return "Bot level " + to_string(int(config("Bot", color + "BotLevel")));
+        };
+        vector<pair<string, string>> tags = {{"Event", "Checkers"},
+                                             {"Date", date},
+                                             {"White", player_name("White")},
+                                             {"Black", player_name("Black")},
+                                             {"GameType", "25"}};
+        // Партия начата не из стандартной расстановки
+        vector<vector<POS_T>> start_mtx;
+        bool start_color;
+        parse_fen(start_fen, start_mtx, start_color);
+        if (board.history_mtx[0] != start_mtx || first_color)
+            tags.emplace_back("FEN", to_fen(board.history_mtx[0], first_color));
+
+        ofstream fout(project_path + string(path), ios_base::app);
+        write_pdn(fout, tags, turns, first_color, result);
         fout.close();
+    }
+
+    // Бюджет позиций на ход бота цвета color ("White" или "Black"), 0 - ограничен только уровень
+    int64_t bot_nodes(const string &color)
+    {
+        auto budget = config("Bot", color + "BotNodes");
+        return (budget.is_number() ? max(int64_t(0), int64_t(budget)) : 0);
+    }
 
-        // Рекурсивный вызов для повтора игры
+    // Ждет, пока следующий шаг сможет что-то сделать (только для play: ожидание поиска и задержек бота)
+    void idle()
+    {
+        if (state == GameState::BOT_THINK)
+        {
+            bot_future.wait();
+            this_thread::sleep_until(bot_ready);
+        }
+        else if (state == GameState::BOT_MOVE)
+            this_thread::sleep_until(bot_next_move);
+    }
+
+    // Начало партии (или повтор после кнопки "Повтор игры")
+    void start_game()
+    {
+        // Засекаем время начала игры для статистики
+        game_start = chrono::steady_clock::now();
+
+        // Обработка режима повтора игры
         if (is_replay)
-            return play();
-            
-        // Выход из игры
-        if (is_quit)
-            return 0;
-            
-        // Определение результата игры
-        int res = 2;  // По умолчанию победа черных
-        if (turn_num == Max_turns)
         {
-            res = 0;  // Ничья при достижении лимита ходов
+            logic = Logic(&config);          // Пересоздаем логику игры
+            mcts.reset();                    // Бот MCTS создается заново при первом ходе
+            config.reload();                 // Перезагружаем конфигурацию
+            board.redraw();                  // Перерисовываем доску
         }
-        else if (turn_num % 2)
+        else
         {
-            res = 1;  // Победа белых (если последний ход был черных, но у них нет ходов)
+            board.start_draw();              // Первоначальная отрисовка доски
         }
-        
-        // Показываем финальный экран и ждем реакции игрока
-        board.show_final(res);
-        auto resp = hand.wait();
-        if (resp == Response::REPLAY)
+        is_replay = false;
+        is_quit = false;
+
+        // Если задана партия для загрузки (LoadPDN), продолжаем с ее последней позиции
+        turn_num = load_pdn() - 1;           // Счетчик ходов (-1, чтобы первый ход был 0)
+        max_turns = config("Game", "MaxNumTurns");  // Максимальное количество ходов
+        state = GameState::NEXT_TURN;
+    }
+
+    // Переход хода: проверка конца партии, ход человека или запуск поиска бота
+    void next_turn()
+    {
+        if (++turn_num >= max_turns)
         {
-            is_replay = true;
-            return play();  // Запускаем новую игру
+            state = GameState::FINISH;
+            return;
         }
-        return res;
+        beat_series = 0;                     // Сброс счетчика серии взятий
+
+        // Определяем возможные ходы для текущего игрока (turn_num % 2: 0=белые, 1=черные)
+        Logic::find_turns(bool(turn_num % 2), board.get_board(), legal_turns);
+
+        // Если нет доступных ходов - игра окончена
+        if (legal_turns.empty())
+        {
+            state = GameState::FINISH;
+            return;
+        }
+
+        // Устанавливаем глубину поиска для бота в зависимости от цвета
+        logic.Max_depth = config("Bot", string((turn_num % 2) ? "Black" : "White") + string("BotLevel"));
+
+        // Проверяем, играет ли человек или бот за текущий цвет
+        if (!config("Bot", string("Is") + string((turn_num % 2) ? "Black" : "White") + string("Bot")))
+            start_player_turn();
+        else
+            start_bot_turn(turn_num % 2);
     }
 
-  private:
-    // Выполняет ход бота (искусственного интеллекта)
+    // Запускает поиск хода бота в отдельном потоке
     // Параметр color: цвет бота (false = белые, true = черные)
-    void bot_turn(const bool color)
+    void start_bot_turn(const bool color)
     {
         // Засекаем время начала хода бота для статистики
-        auto start = chrono::steady_clock::now();
-
-        // Получаем настроенную задержку для ходов бота
-        auto delay_ms = config("Bot", "BotDelayMS");
-        
-        // Создаем параллельный поток для задержки, чтобы обеспечить минимальное время хода
-        // Пока поток ждет, основной поток вычисляет лучший ход
-        thread th(SDL_Delay, delay_ms);
-        
+        bot_start = chrono::steady_clock::now();
+
+        // Минимальное время хода: ход выполняется не раньше, чем через BotDelayMS
+        bot_delay = chrono::milliseconds(int(config("Bot", "BotDelayMS")));
+        bot_ready = bot_start + bot_delay;
+
         // Находим оптимальную последовательность ходов с помощью алгоритма ИИ
-        auto turns = logic.find_best_turns(color);
-        
-        // Ждем завершения минимальной задержки
-        th.join();
-        
-        bool is_first = true;
-        
-        // Выполняем все ходы в найденной последовательности (обычно это серия взятий)
-        for (auto turn : turns)
-        {
-            // Добавляем задержку между ходами в серии (кроме первого)
-            if (!is_first)
+        // При заданном бюджете позиций (WhiteBotNodes/BlackBotNodes) уровень не важен: итеративное углубление
+        // идет до исчерпания бюджета, поэтому сила бота и время хода не зависят от позиции и скорости машины
+        // Бот MCTS (BotType = "Mcts") вместо уровня и бюджета использует MctsPlayouts случайных партий на ход
+        const int64_t budget = bot_nodes(color ? "Black" : "White");
+        bot_is_mcts = (config("Bot", "BotType").is_string() && string(config("Bot", "BotType")) == "Mcts");
+        if (bot_is_mcts && !mcts)
+            mcts = make_unique<Mcts>(&config);
+        bot_future = async(launch::async, [this, color, budget, mtx = board.get_board()]() {
+            if (bot_is_mcts)
+                return mcts->find_best_turns(mtx, color);
+            if (budget > 0)
             {
-                SDL_Delay(delay_ms);
+                search_limits limits;
+                limits.nodes = budget;
+                return logic.search(mtx, color, limits);
             }
-            is_first = false;
-            
+            return logic.find_best_turns(mtx, color);
+        });
+        state = GameState::BOT_THINK;
+    }
+
+    // Ждет результата поиска и минимальной задержки хода
+    void bot_think_step()
+    {
+        if (bot_future.wait_for(chrono::seconds(0)) != future_status::ready || chrono::steady_clock::now() < bot_ready)
+            return;
+        bot_turns = bot_future.get();
+        // Бот не должен пропускать ход: если поиск не вернул хода, а ходы есть, играем первый допустимый
+        if (bot_turns.empty())
+        {
+            move_list moves;
+            Logic::find_moves(bool(turn_num % 2), board.get_board(), moves);
+            if (!moves.empty())
+                moves[0].to_turns(bot_turns);
+        }
+        bot_index = 0;
+        bot_next_move = chrono::steady_clock::now();
+        state = GameState::BOT_MOVE;
+    }
+
+    // Выполняет очередной ход найденной серии (обычно это серия взятий) с задержкой между ходами
+    void bot_move_step()
+    {
+        auto now = chrono::steady_clock::now();
+        if (now < bot_next_move)
+            return;
+        if (bot_index < bot_turns.size())
+        {
+            const move_pos turn = bot_turns[bot_index++];
+
             // Увеличиваем счетчик взятий, если это ход со взятием (xb != -1)
             beat_series += (turn.xb != -1);
-            
+
             // Выполняем ход на доске с анимацией
             board.move_piece(turn, beat_series);
+
+            // Задержка перед следующим ходом серии
+            bot_next_move = chrono::steady_clock::now() + bot_delay;
+            if (bot_index < bot_turns.size())
+                return;
         }
+        log_bot_turn();
+        state = GameState::NEXT_TURN;
+    }
 
-        // Записываем время выполнения хода бота в лог для анализа производительности
+    // Записывает время выполнения хода бота в лог для анализа производительности
+    void log_bot_turn()
+    {
         auto end = chrono::steady_clock::now();
         ofstream fout(project_path + "log.txt", ios_base::app);
-        fout << "Bot turn time: " << (int)chrono::duration<double, milli>(end - start).count() << " millisec\n";
+        fout << "Bot turn time: " << (int)chrono::duration<double, milli>(end - bot_start).count() << " millisec\n";
+        // Количество случайных партий и доля очков выбранного хода (MCTS)
+        if (bot_is_mcts)
+            fout << "Bot turn playouts: " << mcts->playouts << " (" << mcts->threads_count << " threads), win rate "
+                 << int(mcts->win_rate * 100) << "%\n";
+        // Количество просмотренных позиций и (при AspirationStats) экономия от окна стремления
+        else
+        {
+            fout << "Bot turn nodes: " << logic.nodes;
+            if (config("Bot", "AspirationStats").is_boolean() && config("Bot", "AspirationStats"))
+                fout << " (full window: " << logic.full_window_nodes << ", saved: "
+                     << int64_t(logic.full_window_nodes) - int64_t(logic.nodes) << ")";
+            fout << "\n";
+        }
+        // Доля листьев, оценка которых найдена в кэше (EvalCacheMB), с начала партии
+        if (logic.cache_probes)
+            fout << "Eval cache hits: " << logic.cache_hits * 100 / logic.cache_probes << "% (" << logic.cache_hits << " of "
+                 << logic.cache_probes << ")\n";
+        // Ходов, взятых из кэша анализа на диске (AnalysisCacheFile) без поиска, с начала партии
+        if (logic.analysis_hits)
+            fout << "Analysis cache moves: " << logic.analysis_hits << "\n";
         fout.close();
     }
 
-    // Обрабатывает ход игрока (не бота)
-    // Параметр color: цвет игрока (false = белые, true = черные)
-    // Возвращает Response - результат хода (OK, QUIT, REPLAY, BACK)
-    Response player_turn(const bool color)
+    // Начинает ход человека: подсвечивает все фигуры, которые могут ходить
+    void start_player_turn()
     {
-        // Подготовка к первому ходу - сбор всех возможных начальных позиций
-        vector<pair<POS_T, POS_T>> cells;
-        for (auto turn : logic.turns)
+        start_cells.clear();
+        for (auto turn : legal_turns)
         {
-            cells.emplace_back(turn.x, turn.y);  // Добавляем все клетки с фигурами, которые могут ходить
+            start_cells.emplace_back(turn.x, turn.y);  // Добавляем все клетки с фигурами, которые могут ходить
         }
-        board.highlight_cells(cells);  // Подсвечиваем все доступные для хода фигуры
-        
-        move_pos pos = {-1, -1, -1, -1};  // Инициализируем структуру хода
-        POS_T x = -1, y = -1;             // Координаты выбранной фигуры
-        
-        // Цикл выбора фигуры и целевой клетки для хода
-        while (true)
+        board.highlight_cells(start_cells);  // Подсвечиваем все доступные для хода фигуры
+        active_x = -1;                       // Фигура еще не выбрана
+        active_y = -1;
+        in_series = false;
+        state = GameState::PLAYER;
+    }
+
+    // Обрабатывает одно событие ввода во время хода человека
+    void player_step()
+    {
+        auto resp = hand.poll_cell();  // Ответ от пользователя (клик мыши), если он был
+        if (get<0>(resp) == Response::OK)
+            return;
+        // Если игрок нажал кнопку (не клетку) - выход, повтор игры или откат хода
+        if (get<0>(resp) != Response::CELL)
+        {
+            player_response(get<0>(resp));
+            return;
+        }
+        pair<POS_T, POS_T> cell{get<1>(resp), get<2>(resp)};  // Координаты кликнутой клетки
+        if (in_series)
+            series_cell(cell);
+        else
+            select_cell(cell);
+    }
+
+    // Клик по клетке до первого хода: выбор фигуры или поля, куда она идет
+    void select_cell(const pair<POS_T, POS_T> &cell)
+    {
+        move_pos pos = {-1, -1, -1, -1};  // Полный ход, если клетка - поле хода выбранной фигуры
+        bool is_correct = false;
+
+        // Проверяем, корректна ли кликнутая клетка
+        for (auto turn : legal_turns)
         {
-            auto resp = hand.get_cell();  // Получаем ответ от пользователя (клик мыши)
-            
-            // Если игрок нажал кнопку (не клетку), возвращаем соответствующий ответ
-            if (get<0>(resp) != Response::CELL)
-                return get<0>(resp);
-                
-            pair<POS_T, POS_T> cell{get<1>(resp), get<2>(resp)};  // Координаты кликнутой клетки
-
-            bool is_correct = false;
-            
-            // Проверяем, корректна ли кликнутая клетка
-            for (auto turn : logic.turns)
+            // Проверяем, является ли клетка начальной позицией для возможного хода
+            if (turn.x == cell.first && turn.y == cell.second)
             {
-                // Проверяем, является ли клетка начальной позицией для возможного хода
-                if (turn.x == cell.first && turn.y == cell.second)
-                {
-                    is_correct = true;
-                    break;
-                }
-                // Проверяем, является ли клетка целевой для уже выбранной фигуры
-                if (turn == move_pos{x, y, cell.first, cell.second})
-                {
-                    pos = turn;  // Сохраняем полный ход
-                    break;
-                }
-            }
-            
-            // Если найден полный ход, выходим из цикла
-            if (pos.x != -1)
+                is_correct = true;
                 break;
-                
-            // Если клетка некорректна, сбрасываем выделение
-            if (!is_correct)
+            }
+            // Проверяем, является ли клетка целевой для уже выбранной фигуры
+            if (turn == move_pos{active_x, active_y, cell.first, cell.second})
             {
-                if (x != -1)
-                {
-                    board.clear_active();      // Убираем выделение активной фигуры
-                    board.clear_highlight();   // Убираем подсветку возможных ходов
-                    board.highlight_cells(cells);  // Восстанавливаем исходную подсветку
-                }
-                x = -1;
-                y = -1;
-                continue;
+                pos = turn;  // Сохраняем полный ход
+                break;
             }
-            
-            // Выбираем фигуру и показываем возможные ходы для неё
-            x = cell.first;
-            y = cell.second;
+        }
+
+        // Если найден полный ход, выполняем его
+        if (pos.x != -1)
+        {
             board.clear_highlight();
-            board.set_active(x, y);  // Выделяем выбранную фигуру
-            
-            // Собираем все возможные целевые клетки для выбранной фигуры
-            vector<pair<POS_T, POS_T>> cells2;
-            for (auto turn : logic.turns)
+            board.clear_active();
+            board.move_piece(pos, pos.xb != -1);  // Перемещаем фигуру (pos.xb != -1 означает взятие)
+
+            // Если это не взятие, ход завершен
+            if (pos.xb == -1)
             {
-                if (turn.x == x && turn.y == y)
-                {
-                    cells2.emplace_back(turn.x2, turn.y2);  // Добавляем целевые позиции
-                }
+                state = GameState::NEXT_TURN;
+                return;
             }
-            board.highlight_cells(cells2);  // Подсвечиваем возможные ходы
+            // Обработка серии взятий (если фигура может продолжить бить)
+            beat_series = 1;
+            continue_series(pos);
+            return;
         }
-        
-        // Выполняем первый ход
-        board.clear_highlight();
-        board.clear_active();
-        board.move_piece(pos, pos.xb != -1);  // Перемещаем фигуру (pos.xb != -1 означает взятие)
-        
-        // Если это не взятие, ход завершен
-        if (pos.xb == -1)
-            return Response::OK;
-            
-        // Обработка серии взятий (если фигура может продолжить бить)
-        beat_series = 1;
-        while (true)
-        {
-            // Проверяем, может ли фигура продолжить бить с новой позиции
-            logic.find_turns(pos.x2, pos.y2);
-            if (!logic.have_beats)  // Если больше нет возможности бить
-                break;
 
-            // Собираем возможные целевые клетки для продолжения взятий
-            vector<pair<POS_T, POS_T>> cells;
-            for (auto turn : logic.turns)
+        // Если клетка некорректна, сбрасываем выделение
+        if (!is_correct)
+        {
+            if (active_x != -1)
             {
-                cells.emplace_back(turn.x2, turn.y2);
+                board.clear_active();      // Убираем выделение активной фигуры
+                board.clear_highlight();   // Убираем подсветку возможных ходов
+                board.highlight_cells(start_cells);  // Восстанавливаем исходную подсветку
             }
-            board.highlight_cells(cells);        // Подсвечиваем возможные ходы
-            board.set_active(pos.x2, pos.y2);    // Выделяем фигуру на новой позиции
-            
-            // Цикл выбора следующего хода в серии взятий
-            while (true)
+            active_x = -1;
+            active_y = -1;
+            return;
+        }
+
+        // Выбираем фигуру и показываем возможные ходы для неё
+        active_x = cell.first;
+        active_y = cell.second;
+        board.clear_highlight();
+        board.set_active(active_x, active_y);  // Выделяем выбранную фигуру
+
+        // Собираем все возможные целевые клетки для выбранной фигуры
+        vector<pair<POS_T, POS_T>> cells;
+        for (auto turn : legal_turns)
+        {
+            if (turn.x == active_x && turn.y == active_y)
             {
-                auto resp = hand.get_cell();
-                if (get<0>(resp) != Response::CELL)
-                    return get<0>(resp);
-                pair<POS_T, POS_T> cell{get<1>(resp), get<2>(resp)};
-
-                // Проверяем корректность выбранной целевой клетки
-                bool is_correct = false;
-                for (auto turn : logic.turns)
-                {
-                    if (turn.x2 == cell.first && turn.y2 == cell.second)
-                    {
-                        is_correct = true;
-                        pos = turn;  // Сохраняем ход
-                        break;
-                    }
-                }
-                if (!is_correct)
-                    continue;
+                cells.emplace_back(turn.x2, turn.y2);  // Добавляем целевые позиции
+            }
+        }
+        board.highlight_cells(cells);  // Подсвечиваем возможные ходы
+    }
+
+    // После взятия ходом pos: если фигура может бить дальше, ждем следующего поля серии, иначе ход завершен
+    void continue_series(const move_pos &pos)
+    {
+        // Проверяем, может ли фигура продолжить бить с новой позиции
+        if (!Logic::find_turns(pos.x2, pos.y2, board.get_board(), legal_turns))
+        {
+            in_series = false;
+            state = GameState::NEXT_TURN;
+            return;
+        }
+
+        // Собираем возможные целевые клетки для продолжения взятий
+        vector<pair<POS_T, POS_T>> cells;
+        for (auto turn : legal_turns)
+        {
+            cells.emplace_back(turn.x2, turn.y2);
+        }
+        board.highlight_cells(cells);        // Подсвечиваем возможные ходы
+        board.set_active(pos.x2, pos.y2);    // Выделяем фигуру на новой позиции
+        in_series = true;
+    }
 
+    // Клик по клетке во время серии взятий: следующее поле серии
+    void series_cell(const pair<POS_T, POS_T> &cell)
+    {
+        for (auto turn : legal_turns)
+        {
+            if (turn.x2 == cell.first && turn.y2 == cell.second)
+            {
                 // Выполняем очередной ход в серии взятий
                 board.clear_highlight();
                 board.clear_active();
                 beat_series += 1;  // Увеличиваем счетчик взятий в серии
-                board.move_piece(pos, beat_series);
-                break;
+                board.move_piece(turn, beat_series);
+                continue_series(turn);
+                return;
             }
         }
+    }
+
+    // Обработка кнопок во время хода человека (QUIT, REPLAY, BACK)
+    void player_response(const Response resp)
+    {
+        in_series = false;
+        if (resp == Response::QUIT)
+        {
+            is_quit = true;
+            state = GameState::FINISH;
+        }
+        else if (resp == Response::REPLAY)
+        {
+            is_replay = true;
+            state = GameState::FINISH;
+        }
+        else if (resp == Response::BACK)  // Откат хода назад
+        {
+            // Если предыдущий ход делал бот и это не серия взятий
+            if (config("Bot", string("Is") + string((1 - turn_num % 2) ? "Black" : "White") + string("Bot")) &&
+                !beat_series && board.history_mtx.size() > 2)
+            {
+                board.rollback();    // Откатываем ход бота
+                --turn_num;
+            }
+            if (!beat_series)
+                --turn_num;
 
-        return Response::OK;  // Ход успешно завершен
+            board.rollback();        // Откатываем ход игрока
+            --turn_num;
+            beat_series = 0;
+            state = GameState::NEXT_TURN;
+        }
+    }
+
+    // Конец партии: лог, запись в PDN, затем повтор, выход или финальный экран
+    void finish_game()
+    {
+        // Записываем время игры в лог
+        auto end = chrono::steady_clock::now();
+        ofstream fout(project_path + "log.txt", ios_base::app);
+        fout << "Game time: " << (int)chrono::duration<double, milli>(end - game_start).count() << " millisec\n";
+        fout.close();
+
+        // Сохраняем партию в PDN (прерванная партия записывается с результатом "*")
+        if (is_replay || is_quit)
+            save_pdn("*");
+        else
+            save_pdn(turn_num == max_turns ? "1-1" : (turn_num % 2 ? "2-0" : "0-2"));
+
+        // Повтор игры - снова начальное состояние (без рекурсии)
+        if (is_replay)
+        {
+            state = GameState::START;
+            return;
+        }
+
+        // Выход из игры
+        if (is_quit)
+        {
+            result = 0;
+            state = GameState::DONE;
+            return;
+        }
+
+        // Определение результата игры
+        result = 2;  // По умолчанию победа черных
+        if (turn_num == max_turns)
+        {
+            result = 0;  // Ничья при достижении лимита ходов
+        }
+        else if (turn_num % 2)
+        {
+            result = 1;  // Победа белых (если последний ход был черных, но у них нет ходов)
+        }
+
+        // Показываем финальный экран и ждем реакции игрока
+        board.show_final(result);
+        state = GameState::FINAL;
+    }
+
+    // Финальный экран: повтор игры или выход
+    void final_step()
+    {
+        auto resp = hand.poll_final();
+        if (resp == Response::REPLAY)
+        {
+            is_replay = true;
+            state = GameState::START;  // Запускаем новую игру
+        }
+        else if (resp == Response::QUIT)
+            state = GameState::DONE;
     }
 
   private:
@@ -334,6 +594,27 @@ class Game
     Board board;
     Hand hand;
     Logic logic;
-    int beat_series;
+    unique_ptr<Mcts> mcts;         // Бот MCTS (создается при первом ходе, если BotType = "Mcts")
+    vector<move_pos> legal_turns;  // Допустимые ходы текущего игрока (продолжения серии во время взятия)
+    int beat_series = 0;
     bool is_replay = false;
+    bool is_quit = false;          // Игрок закрыл окно
+
+    // Состояние автомата партии (см. step)
+    GameState state = GameState::START;
+    chrono::steady_clock::time_point game_start;  // Начало партии (для статистики)
+    int turn_num = 0;              // Номер полухода (0 - первый ход белых)
+    int max_turns = 0;             // Ничья после стольких полуходов (MaxNumTurns)
+    // Ход человека
+    vector<pair<POS_T, POS_T>> start_cells;  // Фигуры, которые могут ходить
+    POS_T active_x = -1, active_y = -1;      // Выбранная фигура (-1 - не выбрана)
+    bool in_series = false;                  // Идет серия взятий: ждем следующего поля
+    // Ход бота
+    future<vector<move_pos>> bot_future;     // Поиск хода в отдельном потоке
+    vector<move_pos> bot_turns;              // Найденная серия ходов
+    size_t bot_index = 0;                    // Следующий ход серии
+    bool bot_is_mcts = false;                // Ход ищет бот MCTS
+    chrono::milliseconds bot_delay{0};       // Задержка BotDelayMS
+    chrono::steady_clock::time_point bot_start, bot_ready, bot_next_move;
+    bool first_color = false;  // Кто ходил первым в текущей партии (черные - в партиях, загруженных из PDN)
 };
@@ -0,0 +1,124 @@
+#pragma once
+#include <cstdint>
+
+// Векторное ядро выбирается при компиляции: AVX2 (-mavx2 / CHECKERS_NATIVE) или скалярное
+// LEAF_BATCH_SCALAR принудительно включает скалярное ядро (для проверки)
+#if defined(__AVX2__) && !defined(LEAF_BATCH_SCALAR)
+    #define LEAF_BATCH_AVX2
+    #include <immintrin.h>
+#elif defined(_MSC_VER)
+    #include <intrin.h>
+#endif
+
+#include "../Models/Move.h"
+#include "../Models/Packed.h"
+
+// Пакетная оценка листьев: все дети узла перед листьями записываются в leaf_batch
+// (множества полей белых, черных и дамок по 32 бита) и оцениваются одним проходом по массивам
+// Оценка материальная, как calc_score в режимах NumberOnly и NumberAndPotential
+
+// Маски рядов для продвижения шашек: бит k количества пройденных рядов (белые - 7 - x, черные - x)
+const uint32_t ADVANCE_WHITE[3] = {0x0F0F0F0Fu, 0x00FF00FFu, 0x0000FFFFu};
+const uint32_t ADVANCE_BLACK[3] = {0xF0F0F0F0u, 0xFF00FF00u, 0xFFFF0000u};
+
+inline int popcount32(const uint32_t v)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcount(v);
+#elif defined(_MSC_VER)
+    return int(__popcnt(v));
+#else
+    int res = 0;
+    for (uint32_t x = v; x; x &= x - 1)
+        ++res;
+    return res;
+#endif
+}
+
+// Записывает в batch позиции после каждого из ходов moves из позиции parent
+// Побитые фигуры берутся из маски full_move::beats, номер бита которой совпадает с номером темного поля
+inline void fill_leaf_batch(const packed_position &parent, const move_list &moves, leaf_batch &batch)
+{
+    const bool is_white = !parent.color;
+    batch.size = moves.size();
+    for (size_t i = 0; i < moves.size(); ++i)
+    {
+        const full_move &move = moves[i];
+        const uint32_t from = uint32_t(1) << square_index(move.x, move.y);
+        const uint32_t to = uint32_t(1) << square_index(move.x2, move.y2);
+        const uint32_t own = ((is_white ? parent.white : parent.black) & ~from) | to;
+        const uint32_t other = (is_white ? parent.black : parent.white) & ~move.beats;
+        uint32_t kings = parent.kings & ~(from | move.beats);
+        if ((parent.kings & from) || move.is_promotion)
+            kings |= to;
+        batch.white[i] = (is_white ? own : other);
+        batch.black[i] = (is_white ? other : own);
+        batch.kings[i] = kings;
+    }
+    // Хвост до кратного 8 - пустые позиции (векторное ядро обрабатывает по 8)
+    for (size_t i = moves.size(); i < (moves.size() + 7) / 8 * 8; ++i)
+        batch.white[i] = batch.black[i] = batch.kings[i] = 0;
+}
+
+#if defined(LEAF_BATCH_AVX2)
+// Количество единичных битов в каждом 32-битном элементе (таблица на полбайта и pshufb)
+inline __m256i popcount_epi32(const __m256i v)
+{
+    const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3,
+                                            2, 3, 3, 4);
+    const __m256i low_mask = _mm256_set1_epi8(0x0F);
+    const __m256i lo = _mm256_and_si256(v, low_mask), hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), low_mask);
+    const __m256i bytes = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, lo), _mm256_shuffle_epi8(lookup, hi));
+    // Суммы байтов внутри каждого 32-битного элемента
+    return _mm256_madd_epi16(_mm256_maddubs_epi16(bytes, _mm256_set1_epi8(1)), _mm256_set1_epi16(1));
+}
+
+// Взвешенное продвижение шашек men по маскам рядов
+inline __m256i advance_epi32(const __m256i men, const uint32_t masks[3])
+{
+    __m256i res = popcount_epi32(_mm256_and_si256(men, _mm256_set1_epi32(int(masks[0]))));
+    res = _mm256_add_epi32(res, _mm256_slli_epi32(popcount_epi32(_mm256_and_si256(men, _mm256_set1_epi32(int(masks[1])))), 1));
+    return _mm256_add_epi32(res, _mm256_slli_epi32(popcount_epi32(_mm256_and_si256(men, _mm256_set1_epi32(int(masks[2])))), 2));
+}
+#endif
+
+// Оценивает все позиции пачки с точки зрения белых: man за шашку, king за дамку, advance за пройденный шашкой ряд
+// Результат в scores (не меньше batch.size, округленного вверх до 8); отсутствие фигур у стороны проверяет вызывающий
+inline void score_leaf_batch(const leaf_batch &batch, const int man, const int king, const int advance, int32_t *scores)
+{
+#if defined(LEAF_BATCH_AVX2)
+    const __m256i man_w = _mm256_set1_epi32(man), king_w = _mm256_set1_epi32(king), advance_w = _mm256_set1_epi32(advance);
+    for (size_t i = 0; i < batch.size; i += 8)
+    {
+        const __m256i white = _mm256_load_si256(reinterpret_cast<const __m256i *>(batch.white + i));
+        const __m256i black = _mm256_load_si256(reinterpret_cast<const __m256i *>(batch.black + i));
+        const __m256i kings = _mm256_load_si256(reinterpret_cast<const __m256i *>(batch.kings + i));
+        const __m256i white_men = _mm256_andnot_si256(kings, white), black_men = _mm256_andnot_si256(kings, black);
+        const __m256i men = _mm256_sub_epi32(popcount_epi32(white_men), popcount_epi32(black_men));
+        const __m256i queens =
+            _mm256_sub_epi32(popcount_epi32(_mm256_and_si256(white, kings)), popcount_epi32(_mm256_and_si256(black, kings)));
+        __m256i score = _mm256_add_epi32(_mm256_mullo_epi32(men, man_w), _mm256_mullo_epi32(queens, king_w));
+        if (advance)
+        {
+            const __m256i rows = _mm256_sub_epi32(advance_epi32(white_men, ADVANCE_WHITE), advance_epi32(black_men, ADVANCE_BLACK));
+            score = _mm256_add_epi32(score, _mm256_mullo_epi32(rows, advance_w));
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(scores + i), score);
+    }
+#else
+    for (size_t i = 0; i < batch.size; ++i)
+    {
+        const uint32_t white_men = batch.white[i] & ~batch.kings[i], black_men = batch.black[i] & ~batch.kings[i];
+        int score = man * (popcount32(white_men) - popcount32(black_men)) +
+                    king * (popcount32(batch.white[i] & batch.kings[i]) - popcount32(batch.black[i] & batch.kings[i]));
+        if (advance)
+        {
+            int rows = 0;
+            for (int k = 0; k < 3; ++k)
+                rows += (popcount32(white_men & ADVANCE_WHITE[k]) - popcount32(black_men & ADVANCE_BLACK[k])) << k;
+            score += advance * rows;
+        }
+        scores[i] = score;
+    }
+#endif
+}
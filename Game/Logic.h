@@ -1,56 +1,373 @@
 #pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <memory>
 #include <random>
+#include <thread>
 #include <vector>
 
 #include "../Models/Move.h"
-#include "Board.h"
+#include "../Models/Search.h"
+#include "../Models/Zobrist.h"
 #include "Config.h"
+#include "AnalysisCache.h"
+#include "EvalCache.h"
+#include "LeafBatch.h"
+#include "Evaluator.h"
+#include "Nnue.h"
 
 const int INF = 1e9;
 
+// Отметки входа в рекурсию поиска и выхода из нее: Tools/alloc_check.cpp (ctest) проверяет, что между ними
+// нет выделений памяти. В обычной сборке ничего не делают
+#ifdef CHECKERS_ALLOC_CHECK
+void alloc_check_mark(bool in_recursion);
+    #define ALLOC_CHECK_MARK(in_recursion) alloc_check_mark(in_recursion)
+#else
+    #define ALLOC_CHECK_MARK(in_recursion)
+#endif
+
 class Logic
 {
   public:
-    Logic(Board *board, Config *config) : board(board), config(config)
+    Logic(Config *config) : config(config), arena(make_unique<search_arena>())
     {
         rand_eng = std::default_random_engine (
             !((*config)("Bot", "NoRandom")) ? unsigned(time(0)) : 0);
         scoring_mode = (*config)("Bot", "BotScoringType");
         optimization = (*config)("Bot", "Optimization");
+        is_potential = (scoring_mode == "NumberAndPotential");
+        is_weights = (scoring_mode == "Weights");
+        is_nnue = (scoring_mode == "Nnue");
+        is_pruning = (optimization != "O0");
+        // Новые настройки могут отсутствовать в старых settings.json
+        auto window = (*config)("Bot", "AspirationWindow");
+        aspiration_window = (window.is_number() ? int(window) : 50);
+        auto stats = (*config)("Bot", "AspirationStats");
+        aspiration_stats = (stats.is_boolean() && bool(stats));
+        // Веса оценки: без файла используются веса по умолчанию (Models/Weights.h)
+        // Испорченный файл не мешает игре: ошибка пишется в log.txt, веса остаются по умолчанию
+        auto weights_path = (*config)("Bot", "EvalWeights");
+        if ((is_weights || is_nnue) && weights_path.is_string() && ifstream(project_path + string(weights_path)).good())
+        {
+            try
+            {
+                Evaluator loaded;
+                loaded.load(project_path + string(weights_path));
+                evaluator = loaded;
+            }
+            catch (const exception &e)
+            {
+                log_error(string("can't load weights: ") + e.what());
+            }
+        }
+        // Ограничение скорости поиска (позиций в секунду): 0 или отсутствие настройки - без ограничения
+        auto nps = (*config)("Bot", "NodesPerSecond");
+        nps_limit = (nps.is_number() && int64_t(nps) > 0 ? uint64_t(int64_t(nps)) : 0);
+        auto cache_mb = (*config)("Bot", "EvalCacheMB");
+        // Пакетная оценка листьев: только для материальных оценок, по умолчанию включена
+        // Пакет не обращается к кэшу оценок, поэтому с кэшем (EvalCacheMB) листья оцениваются по одному
+        auto batch = (*config)("Bot", "BatchLeaves");
+        batch_leaves = !is_weights && !is_nnue && !(batch.is_boolean() && !bool(batch)) &&
+                       !(cache_mb.is_number() && int(cache_mb) > 0);
+        // Описание оценки для соли общих кэшей: процессы с разными оценками делят таблицу, но не видят записи друг друга
+        string eval_id = scoring_mode;
+        for (const json &file : {weights_path, (*config)("Bot", "NnueFile")})
+            eval_id += "|" + (file.is_string() ? string(file) : string());
+        if (cache_mb.is_number() && int(cache_mb) > 0)
+        {
+            // Общий для процессов кэш (EvalCacheShm); без общей памяти - кэш только этого Logic
+            auto shm_name = (*config)("Bot", "EvalCacheShm");
+            if (shm_name.is_string() && !string(shm_name).empty())
+            {
+                try
+                {
+                    eval_cache = make_shared<EvalCache>(size_t(int(cache_mb)), string(shm_name), EvalCache::salt_of(eval_id));
+                }
+                catch (const exception &)
+                {
+                    // Сегмент недоступен: ниже создается кэш только этого Logic
+                }
+            }
+            if (!eval_cache)
+                eval_cache = make_shared<EvalCache>(size_t(int(cache_mb)));
+        }
+        // Кэш анализа на диске (AnalysisCacheFile): результат поиска зависит еще и от отсечений (Optimization)
+        auto analysis_path = (*config)("Bot", "AnalysisCacheFile");
+        if (analysis_path.is_string() && !string(analysis_path).empty())
+        {
+            auto analysis_mb = (*config)("Bot", "AnalysisCacheMB");
+            try
+            {
+                analysis_cache = make_shared<AnalysisCache>(project_path + string(analysis_path),
+                                                            size_t(analysis_mb.is_number() ? max(0, int(analysis_mb)) : 16),
+                                                            EvalCache::salt_of(eval_id + "|" + optimization));
+            }
+            catch (const exception &)
+            {
+                // Файл недоступен: бот работает без кэша анализа
+            }
+        }
+        // Нейросеть: без файла - сеть из линейной части оценки по весам
+        if (is_nnue)
+        {
+            network = make_shared<Nnue>();
+            auto network_path = (*config)("Bot", "NnueFile");
+            bool loaded = false;
+            if (network_path.is_string() && ifstream(project_path + string(network_path)).good())
+            {
+                try
+                {
+                    network->load(project_path + string(network_path));
+                    loaded = true;
+                }
+                catch (const exception &e)
+                {
+                    log_error(string("can't load network: ") + e.what());
+                }
+            }
+            if (!loaded)
+                network->init_from(evaluator);
+        }
+    }
+
+    // Задает зерно перемешивания ходов (при NoRandom перемешивания нет, зерно не меняется)
+    // Без вызова зерно берется из времени запуска, одинакового у потоков, созданных в одну секунду
+    void seed(const unsigned value)
+    {
+        if (!((*config)("Bot", "NoRandom")))
+            rand_eng.seed(value);
     }
 
     // Главная функция поиска лучшей последовательности ходов для бота
-    // Использует алгоритм минимакс для определения оптимальной стратегии
+    // Использует алгоритм negamax с поиском главного варианта (PVS) для определения оптимальной стратегии
+    // Параметр mtx: позиция, в которой ищется ход (не обязательно текущая доска игры)
     // Параметр color: цвет бота (false = белые, true = черные)
     // Возвращает вектор ходов, которые следует выполнить (обычно серия взятий)
-    vector<move_pos> find_best_turns(const bool color)
+    // Оценка найденного хода сохраняется в last_score, количество просмотренных позиций - в nodes
+    // Поиск ведется с узким окном вокруг оценки предыдущего хода этого же цвета (см. aspiration_search)
+    vector<move_pos> find_best_turns(const vector<vector<POS_T>> &mtx, const bool color)
     {
-        // Очищаем структуры данных для отслеживания лучших ходов
-        next_best_state.clear();  // Массив ссылок на следующие состояния
-        next_move.clear();        // Массив лучших ходов для каждого состояния
-        
-        // Запускаем поиск лучшего первого хода с текущего состояния доски
-        // Начинаем с состояния 0, без предыдущих ходов (-1, -1)
-        find_first_best_turn(board->get_board(), color, -1, -1, 0);
-        
-        // Восстанавливаем последовательность лучших ходов по цепочке состояний
-        int cur_state = 0;           // Начинаем с начального состояния
-        vector<move_pos> result;     // Результирующая последовательность ходов
-        
-        // Проходим по цепочке лучших состояний до конца
-        do {
-            result.push_back(next_move[cur_state]);      // Добавляем ход из текущего состояния
-            cur_state = next_best_state[cur_state];      // Переходим к следующему состоянию
-        } while (cur_state != -1 && next_move[cur_state].x != -1);  // Пока не дойдем до конца цепочки
-        
-        return result;
+        nodes = 0;
+        checked_nodes = 0;
+        // Ограничения предыдущего search (бюджет, время) к этому поиску не относятся
+        aborted = false;
+        has_node_limit = false;
+        has_deadline = false;
+        search_start = chrono::steady_clock::now();
+        // Позиция уже просчитана на этом уровне или глубже (в том числе в прошлых запусках): поиск не нужен
+        uint64_t root_key = 0;
+        if (analysis_cache)
+        {
+            root_key = zobrist_hash(mtx, color);
+            vector<move_pos> turns;
+            if (probe_analysis(mtx, color, root_key, turns))
+                return turns;
+        }
+        // Для статистики тот же поиск выполняется с полным окном и тем же порядком ходов
+        if (aspiration_stats)
+        {
+            auto saved_eng = rand_eng;
+            search_root(mtx, color, 1, -INF, INF);
+            full_window_nodes = nodes;
+            nodes = 0;
+            rand_eng = saved_eng;
+        }
+        auto lines = (has_prev_score[color] ? aspiration_search(mtx, color, prev_score[color]) : search_root(mtx, color, 1, -INF, INF));
+        // Ходов нет (или поиск прерван до первого хода)
+        if (lines.empty())
+            return {};
+        prev_score[color] = lines[0].score;
+        has_prev_score[color] = true;
+        if (analysis_cache)
+            store_analysis(root_key, lines[0]);
+        return lines[0].turns;
+    }
+
+    // Анализ нескольких лучших ходов (multi-PV): возвращает до count лучших ходов из корня
+    // по убыванию оценки, каждый с точной оценкой и главным вариантом
+    vector<pv_line> find_best_lines(const vector<vector<POS_T>> &mtx, const bool color, const size_t count)
+    {
+        return search_root(mtx, color, count, -INF, INF);
+    }
+
+    // Поиск с окном стремления (aspiration window): корень ищется в узком окне вокруг ожидаемой оценки guess,
+    // что отсекает больше позиций; если оценка вышла за окно, оно расширяется вдвое в эту сторону и поиск повторяется
+    // Возвращает лучший ход с точной оценкой (как find_best_lines с count = 1)
+    vector<pv_line> aspiration_search(const vector<vector<POS_T>> &mtx, const bool color, const int guess)
+    {
+        int delta = aspiration_window;
+        // Окно выключено или ожидается выигрыш: его оценка зависит от глубины, ищем с полным окном
+        if (delta <= 0 || abs(guess) >= INF - 1000)
+            return search_root(mtx, color, 1, -INF, INF);
+        int alpha = max(-INF, guess - delta), beta = min(INF, guess + delta);
+        while (true)
+        {
+            auto lines = search_root(mtx, color, 1, alpha, beta);
+            if (aborted || lines.empty())
+                return lines;
+            const int score = lines[0].score;
+            delta = min(INF, delta * 2);
+            if (score <= alpha && alpha > -INF)
+                alpha = max(-INF, score - delta);
+            else if (score >= beta && beta < INF)
+                beta = min(INF, score + delta);
+            else
+                return lines;
+            ++aspiration_researches;
+        }
+    }
+
+    // Поиск в корне: до count лучших ходов в окне (alpha, beta)
+    // Каждый следующий ход сначала проверяется нулевым окном на оценке count-го лучшего из уже найденных:
+    // заведомо худшие ходы отсекаются так же быстро, как при поиске одного лучшего хода
+    // Если лучшая оценка не больше alpha или не меньше beta, она не точна (границы для aspiration_search)
+    vector<pv_line> search_root(const vector<vector<POS_T>> &mtx, const bool color, const size_t count, const int alpha,
+                                const int beta)
+    {
+        // Дальше поиск работает с доской фиксированного размера
+        BOARD_T root_mtx;
+        for (POS_T i = 0; i < 8; ++i)
+            for (POS_T j = 0; j < 8; ++j)
+                root_mtx[i][j] = mtx[i][j];
+        move_list &root_moves = arena->turns[0];
+        find_moves(color, root_mtx, root_moves);
+        const eval_acc root_acc = (is_weights ? evaluator.init(root_mtx) : eval_acc());
+        if (is_nnue)
+            network->refresh(root_mtx, arena->nnue[0]);
+        if (eval_cache)
+            arena->hash[0] = zobrist_hash(root_mtx, color);
+        // Перемешиваем ходы для случайности (если включено в настройках)
+        shuffle(root_moves.begin(), root_moves.end(), rand_eng);
+
+        vector<pv_line> lines;
+        for (auto &move : root_moves)
+        {
+            // При остановке поиска оставляем уже просмотренные ходы
+            if (is_stopped())
+                break;
+            const BOARD_T new_mtx = make_move(root_mtx, move);
+            eval_acc acc = root_acc;
+            if (is_weights)
+                evaluator.update(acc, root_mtx, move);
+            if (is_nnue)
+            {
+                arena->nnue[1] = arena->nnue[0];
+                network->update(arena->nnue[1], root_mtx, move);
+            }
+            if (eval_cache)
+                arena->hash[1] = zobrist_update(arena->hash[0], root_mtx, move);
+            int score;
+            if (lines.size() < count)
+                score = -search_child(new_mtx, !color, acc, -beta, -alpha);
+            else
+            {
+                const int cur_alpha = max(alpha, lines.back().score);
+                // Ход не лучше count-го: его оценка не точна, и в список он не попадает
+                if (is_pruning && -search_child(new_mtx, !color, acc, -cur_alpha - 1, -cur_alpha) <= cur_alpha)
+                    continue;
+                score = -search_child(new_mtx, !color, acc, -beta, -cur_alpha);
+                if (score <= cur_alpha)
+                    continue;
+            }
+            pv_line line;
+            move.to_turns(line.turns);
+            line.score = score;
+            line.pv = line.turns;
+            for (size_t i = 0; i < arena->pv_size[1]; ++i)
+                arena->pv[1][i].to_turns(line.pv);
+            // При равных оценках выше остается ход, найденный раньше
+            auto pos = lines.begin();
+            while (pos != lines.end() && pos->score >= score)
+                ++pos;
+            lines.insert(pos, line);
+            if (lines.size() > count)
+                lines.pop_back();
+            // Ход лучше beta: остальные ходы смотреть незачем
+            if (is_pruning && score >= beta)
+                break;
+        }
+        // Ходов нет - поражение
+        last_score = (lines.empty() ? -INF : lines[0].score);
+        return lines;
+    }
+
+    // Поиск из хода корня (уровень 1); рекурсия не выделяет память (см. ALLOC_CHECK_MARK)
+    int search_child(const BOARD_T &mtx, const bool color, const eval_acc &acc, const int alpha, const int beta)
+    {
+        ALLOC_CHECK_MARK(true);
+        const int score = find_best_turns_rec(mtx, color, 1, acc, alpha, beta);
+        ALLOC_CHECK_MARK(false);
+        return score;
+    }
+
+    // Поиск с итеративным углублением: уровни 0, 1, ... до limits.depth
+    // Останавливается по времени (limits.movetime_ms), по бюджету позиций (limits.nodes), по флагу stop_flag
+    // или по достижении глубины. Бюджет проверяется начиная с уровня 1, поэтому ход находится при любом бюджете;
+    // при одинаковом бюджете (и NoRandom) результат одинаков на любой машине
+    // После каждой завершенной итерации вызывает on_info (если задан)
+    // Возвращает лучший ход последней завершенной итерации
+    vector<move_pos> search(const vector<vector<POS_T>> &mtx, const bool color, const search_limits &limits,
+                            const function<void(const search_info &)> &on_info = nullptr)
+    {
+        auto start = chrono::steady_clock::now();
+        search_start = start;
+        nodes = 0;
+        checked_nodes = 0;
+        aborted = false;
+        has_node_limit = false;
+        has_deadline = (limits.movetime_ms >= 0 && !limits.infinite);
+        if (has_deadline)
+            deadline = start + chrono::milliseconds(limits.movetime_ms);
+
+        // Без ограничения по глубине углубляемся до остановки по времени, по бюджету или по флагу
+        const int max_level = (limits.depth >= 0 && !limits.infinite) ? limits.depth : 64;
+        vector<move_pos> best;
+        for (int level = 0; level <= max_level; ++level)
+        {
+            Max_depth = level;
+            has_node_limit = (limits.nodes >= 0 && level > 0);
+            node_limit = uint64_t(max(int64_t(0), limits.nodes));
+            // Окно стремления строится вокруг оценки предыдущей итерации (в режиме multi-PV нужен полный поиск)
+            auto lines = (multi_pv <= 1 && level > 0 && !best.empty() ? aspiration_search(mtx, color, last_score)
+                                                                      : find_best_lines(mtx, color, max(size_t(1), multi_pv)));
+            // Результат прерванной итерации используем, только если других нет
+            if (aborted)
+            {
+                if (best.empty() && !lines.empty())
+                    best = lines[0].turns;
+                break;
+            }
+            best = (lines.empty() ? vector<move_pos>() : lines[0].turns);
+            if (on_info)
+            {
+                search_info info;
+                info.depth = level;
+                info.score = last_score;
+                info.nodes = nodes;
+                info.time_ms = int(chrono::duration<double, milli>(chrono::steady_clock::now() - start).count());
+                if (!lines.empty())
+                    info.pv = lines[0].pv;
+                info.lines = lines;
+                on_info(info);
+            }
+            // Нет ходов: углубляться бессмысленно
+            if (best.empty())
+                break;
+        }
+        has_deadline = false;
+        has_node_limit = false;
+        return best;
     }
 
-private:
     // Выполняет ход на копии доски и возвращает новое состояние
-    // Параметр mtx: текущее состояние доски
+    // Параметр mtx: текущее состояние доски (vector<vector<POS_T>> или BOARD_T)
     // Параметр turn: ход для выполнения
-    vector<vector<POS_T>> make_turn(vector<vector<POS_T>> mtx, move_pos turn) const
+    template <class Matrix> static Matrix make_turn(Matrix mtx, const move_pos turn)
     {
         // Удаляем побитую фигуру (если есть взятие)
         if (turn.xb != -1)
@@ -67,13 +384,38 @@ private:
         return mtx;
     }
 
-    // Вычисляет оценку позиции на доске для алгоритма минимакс
-    // Параметр mtx: состояние доски
-    // Параметр first_bot_color: цвет бота для которого максимизируем оценку
-    double calc_score(const vector<vector<POS_T>> &mtx, const bool first_bot_color) const
+    // Выполняет полный ход (серию взятий целиком) на копии доски и возвращает новое состояние
+    template <class Matrix> static Matrix make_move(Matrix mtx, const full_move &move)
+    {
+        const POS_T type = mtx[move.x][move.y];
+        mtx[move.x][move.y] = 0;
+        // Убираем побитые фигуры
+        for (uint8_t i = 0; i < move.size; ++i)
+            mtx[move.beat_path[i] / 8][move.beat_path[i] % 8] = 0;
+        // Ставим фигуру на конечное поле (шашка могла стать дамкой по пути)
+        mtx[move.x2][move.y2] = type + (move.is_promotion ? 2 : 0);
+        return mtx;
+    }
+
+    // Вычисляет оценку позиции на доске для алгоритма negamax
+    // Оценка симметрична и отсчитывается от нуля: 100 - одна шашка, дамка - 400 (500 в режиме NumberAndPotential),
+    // в режиме NumberAndPotential шашка получает еще 5 за каждый пройденный к дамочному полю ряд,
+    // в режиме Weights оценку считает evaluator по весам из файла EvalWeights, в режиме Nnue - нейросеть из файла NnueFile
+    // Параметр mtx: состояние доски (vector<vector<POS_T>> или BOARD_T)
+    // Параметр color: сторона, с точки зрения которой считается оценка
+    // Возвращает INF, если у противника не осталось фигур, и -INF, если их не осталось у color
+    template <class Matrix> int calc_score(const Matrix &mtx, const bool color) const
     {
+        if (is_weights)
+            return weights_score(mtx, evaluator.init(mtx), color);
+        if (is_nnue)
+        {
+            nnue_acc acc;
+            network->refresh(mtx, acc);
+            return nnue_score(acc, color);
+        }
         // Подсчитываем материальное преимущество и позиционные факторы
-        double w = 0, wq = 0, b = 0, bq = 0;
+        int w = 0, wq = 0, b = 0, bq = 0, wp = 0, bp = 0;
         for (POS_T i = 0; i < 8; ++i)
         {
             for (POS_T j = 0; j < 8; ++j)
@@ -82,189 +424,287 @@ private:
                 wq += (mtx[i][j] == 3);
                 b += (mtx[i][j] == 2);
                 bq += (mtx[i][j] == 4);
-                if (scoring_mode == "NumberAndPotential")
+                if (is_potential)
                 {
-                    w += 0.05 * (mtx[i][j] == 1) * (7 - i);
-                    b += 0.05 * (mtx[i][j] == 2) * (i);
+                    wp += (mtx[i][j] == 1) * (7 - i);
+                    bp += (mtx[i][j] == 2) * i;
                 }
             }
         }
-        if (!first_bot_color)
-        {
-            swap(b, w);
-            swap(bq, wq);
-        }
         if (w + wq == 0)
-            return INF;
+            return color ? INF : -INF;
         if (b + bq == 0)
-            return 0;
-        int q_coef = 4;
-        if (scoring_mode == "NumberAndPotential")
+            return color ? -INF : INF;
+        const int q_coef = (is_potential ? 5 : 4);
+        const int score = 100 * (w - b) + 100 * q_coef * (wq - bq) + 5 * (wp - bp);
+        return color ? -score : score;
+    }
+
+private:
+    // Оценка позиции в режиме Weights по накопителю acc (см. calc_score)
+    template <class Matrix> int weights_score(const Matrix &mtx, const eval_acc &acc, const bool color) const
+    {
+        if (acc.count[1] + acc.count[3] == 0)
+            return color ? INF : -INF;
+        if (acc.count[2] + acc.count[4] == 0)
+            return color ? -INF : INF;
+        return evaluator.evaluate(mtx, acc, color);
+    }
+
+    // Оценка позиции в режиме Nnue по накопителю acc (см. calc_score)
+    int nnue_score(const nnue_acc &acc, const bool color) const
+    {
+        if (acc.count[0] == 0)
+            return color ? INF : -INF;
+        if (acc.count[1] == 0)
+            return color ? -INF : INF;
+        return network->evaluate(acc, color);
+    }
+
+    // Ищет в кэше анализа ход для позиции с хешем key, найденный на уровне не ниже Max_depth
+    // Сохраненный ход проверяется по списку допустимых ходов (защита от совпадения хешей)
+    bool probe_analysis(const vector<vector<POS_T>> &mtx, const bool color, const uint64_t key, vector<move_pos> &turns)
+    {
+        analysis_entry entry;
+        if (!analysis_cache->probe(key, entry) || entry.depth < Max_depth)
+            return false;
+        move_list &moves = arena->turns[0];
+        find_moves(color, mtx, moves);
+        for (auto &move : moves)
         {
-            q_coef = 5;
+            if (square_index(move.x, move.y) == entry.from && square_index(move.x2, move.y2) == entry.to &&
+                move.beats == entry.beats)
+            {
+                move.to_turns(turns);
+                last_score = entry.score;
+                prev_score[color] = entry.score;
+                has_prev_score[color] = true;
+                ++analysis_hits;
+                return true;
+            }
         }
-        return (b + bq * q_coef) / (w + wq * q_coef);
+        return false;
     }
 
-    // Специальная функция для обработки серий взятий (множественных ходов одной фигуры)
-    // В шашках, если фигура может продолжить бить после первого взятия, она обязана это сделать
-    // Параметры:
-    //   mtx: текущее состояние доски
-    //   color: цвет играющей стороны
-    //   x, y: координаты фигуры (-1,-1 для первого хода)
-    //   state: индекс текущего состояния в массивах next_move/next_best_state
-    //   alpha: альфа-значение для отсечения (по умолчанию -1)
-    double find_first_best_turn(vector<vector<POS_T>> mtx, const bool color, const POS_T x, const POS_T y, size_t state, double alpha = -1)
+    void store_analysis(const uint64_t key, const pv_line &line)
     {
-        // Добавляем новое состояние в структуры отслеживания
-        next_best_state.push_back(-1);           // Изначально нет следующего состояния
-        next_move.emplace_back(-1, -1, -1, -1);  // Изначально нет хода
-        
-        double best_score = -1;  // Лучший найденный счет (для максимизирующего игрока)
-        
-        // Если это не первый ход в серии, ищем продолжение взятий с конкретной позиции
-        if (state != 0) {
-            find_turns(x, y, mtx);
-        }
-        
-        // Сохраняем текущие найденные ходы
-        auto turns_now = turns;
-        bool have_beats_now = have_beats;
-        
-        // Если нет взятий и это не первый ход в серии, передаем ход противнику
-        if (!have_beats_now && state != 0) {
-            return find_best_turns_rec(mtx, 1 - color, 0, alpha);
+        analysis_entry entry;
+        entry.key = key;
+        entry.score = line.score;
+        entry.depth = int16_t(Max_depth);
+        entry.from = uint8_t(square_index(line.turns.front().x, line.turns.front().y));
+        entry.to = uint8_t(square_index(line.turns.back().x2, line.turns.back().y2));
+        for (auto &turn : line.turns)
+        {
+            if (turn.xb != -1)
+                entry.beats |= uint32_t(1) << square_index(turn.xb, turn.yb);
         }
-        
-        // Перебираем все возможные ходы
-        for (auto turn : turns_now) {
-            size_t next_state = next_move.size();  // Индекс следующего состояния
-            double score;
-            
-            if (have_beats_now) {
-                // Если есть взятия, рекурсивно ищем продолжение серии взятий
-                score = find_first_best_turn(make_turn(mtx, turn), color, turn.x2, turn.y2, next_state, best_score);
-            } else {
-                // Если нет взятий, переходим к обычному алгоритму минимакс
-                score = find_best_turns_rec(make_turn(mtx, turn), 1 - color, 0, best_score);
-            }
-            
-            // Обновляем лучший ход, если найден лучший счет
-            if (score > best_score) {
-                best_score = score;
-                // Сохраняем ссылку на следующее состояние (если есть продолжение взятий)
-                next_best_state[state] = (have_beats_now ? int(next_state) : -1);
-                next_move[state] = turn;  // Сохраняем лучший ход
+        analysis_cache->store(entry);
+    }
+
+    // Оценка листа на высоте depth (см. calc_score): из кэша оценок, если позиция в нем есть
+    int leaf_score(const BOARD_T &mtx, const bool color, const size_t depth, const eval_acc &acc)
+    {
+        int score;
+        if (eval_cache)
+        {
+            ++cache_probes;
+            if (eval_cache->probe(arena->hash[depth], score))
+            {
+                ++cache_hits;
+                return score;
             }
         }
-        
-        return best_score;
+        if (is_nnue)
+            score = nnue_score(arena->nnue[depth], color);
+        else
+            score = (is_weights ? weights_score(mtx, acc, color) : calc_score(mtx, color));
+        if (eval_cache)
+            eval_cache->store(arena->hash[depth], score);
+        return score;
     }
 
-    // Основной рекурсивный алгоритм минимакс с альфа-бета отсечением
-    // Реализует игровое дерево для поиска оптимального хода на заданную глубину
+    // Основной рекурсивный алгоритм negamax с альфа-бета отсечением и поиском главного варианта
+    // Оценка всегда считается с точки зрения ходящей стороны: оценка хода - оценка ответа противника с обратным знаком
+    // Серия взятий - один ход (full_move), поэтому каждый уровень рекурсии - ровно один полуход
     // Параметры:
     //   mtx: текущее состояние доски
     //   color: цвет текущего игрока (0=белые, 1=черные)
-    //   depth: текущая глубина поиска
-    //   alpha: лучший счет для максимизирующего игрока (альфа-отсечение)
-    //   beta: лучший счет для минимизирующего игрока (бета-отсечение)
-    //   x, y: координаты конкретной фигуры для продолжения серии взятий (-1,-1 для обычного хода)
-    double find_best_turns_rec(vector<vector<POS_T>> mtx, const bool color, const size_t depth, double alpha = -1, double beta = INF + 1, const POS_T x = -1, const POS_T y = -1)
+    //   depth: количество полуходов от корня (корень - 0), позиция оценивается на глубине Max_depth + 1;
+    //          он же индекс буферов этого узла в arena
+    //   acc: накопитель оценки позиции (обновляется по ходу только в режиме Weights;
+    //        накопитель нейросети режима Nnue хранится в arena->nnue[depth])
+    //   alpha: оценка, которую текущий игрок уже может себе гарантировать
+    //   beta: оценка, больше которой противник не допустит (отсечение)
+    // Главный вариант из этой позиции записывается в arena->pv[depth]
+    // Выигрыш и проигрыш оцениваются как INF - depth и -INF + depth: быстрый выигрыш лучше долгого
+    int find_best_turns_rec(const BOARD_T &mtx, const bool color, const size_t depth, const eval_acc &acc, int alpha,
+                            const int beta)
     {
-        // Условие остановки рекурсии: достигнута максимальная глубина поиска
-        if (depth == Max_depth) {
-            // Возвращаем оценку позиции: четные глубины - для начального игрока, нечетные - для противника
-            return calc_score(mtx, (depth % 2 == color));
-        }
-        
-        // Определяем возможные ходы
-        if (x != -1) {
-            // Если заданы конкретные координаты, ищем продолжение серии взятий
-            find_turns(x, y, mtx);
-        } else {
-            // Иначе ищем все возможные ходы для данного цвета
-            find_turns(color, mtx);
+        arena->pv_size[depth] = 0;
+        ++nodes;
+        // Прерванный поиск: значение не важно, результат итерации будет отброшен
+        if (is_stopped())
+            return 0;
+
+        // Условие остановки рекурсии: достигнута максимальная глубина поиска (или закончилась память поиска)
+        if (int(depth) > Max_depth || depth + 1 >= MAX_HEIGHT) {
+            const int score = leaf_score(mtx, color, depth, acc);
+            if (score == INF)
+                return INF - int(depth);
+            if (score == -INF)
+                return -INF + int(depth);
+            return score;
         }
         
-        // Сохраняем результаты поиска ходов
-        auto turns_now = turns;
-        bool have_beats_now = have_beats;
-        
-        // Если нет взятий и мы продолжаем серию взятий, передаем ход противнику
-        if (!have_beats_now && x != -1) {
-            return find_best_turns_rec(mtx, 1 - color, depth + 1, alpha, beta);
-        }
+        // Определяем возможные ходы в буфер этого уровня
+        move_list &turns_now = arena->turns[depth];
+        find_moves(color, mtx, turns_now);
+        // Перемешиваем ходы для случайности (если включено в настройках)
+        shuffle(turns_now.begin(), turns_now.end(), rand_eng);
         
-        // Если нет доступных ходов, игра окончена
+        // Если нет доступных ходов, игра окончена: текущий игрок проиграл
         if (turns_now.empty()) {
-            // Четные глубины - поражение текущего игрока, нечетные - победа
-            return (depth % 2 ? 0 : INF);
+            return -INF + int(depth);
         }
+
+        // Все дети - листья: оцениваем их одним проходом
+        if (batch_leaves && (int(depth) + 1 > Max_depth || depth + 2 >= MAX_HEIGHT))
+            return search_leaves(mtx, color, depth, alpha, beta);
         
-        // Инициализация значений для минимакс алгоритма
-        double min_score = INF + 1;  // Лучший счет для минимизирующего игрока
-        double max_score = -1;       // Лучший счет для максимизирующего игрока
-        
+        int best_score = -INF;
+
         // Перебираем все возможные ходы
-        for (auto turn : turns_now) {
-            double score = 0.0;
-            
-            if (!have_beats_now && x == -1) {
-                // Обычный ход - передаем ход противнику с увеличением глубины
-                score = find_best_turns_rec(make_turn(mtx, turn), 1 - color, depth + 1, alpha, beta);
-            } else {
-                // Продолжение серии взятий - остается тот же игрок, глубина не увеличивается
-                score = find_best_turns_rec(make_turn(mtx, turn), color, depth, alpha, beta, turn.x2, turn.y2);
-            }
-            
-            // Обновляем минимальные и максимальные значения
-            min_score = min(min_score, score);
-            max_score = max(max_score, score);
-            
-            // Альфа-бета отсечение для оптимизации
-            if (depth % 2) {
-                // На нечетных глубинах максимизируем
-                alpha = max(alpha, max_score);
-            } else {
-                // На четных глубинах минимизируем
-                beta = min(beta, min_score);
+        for (size_t i = 0; i < turns_now.size(); ++i) {
+            const full_move &turn = turns_now[i];
+            const int score = search_turn(mtx, color, depth, acc, turn, i == 0, alpha, beta);
+
+            if (score > best_score) {
+                best_score = score;
+                // Запоминаем главный вариант через лучший ход
+                full_move *pv = arena->pv[depth];
+                const size_t child_size = arena->pv_size[depth + 1];
+                pv[0] = turn;
+                copy(arena->pv[depth + 1], arena->pv[depth + 1] + child_size, pv + 1);
+                arena->pv_size[depth] = child_size + 1;
             }
+            alpha = max(alpha, best_score);
             
-            // Отсечение: если alpha >= beta, дальнейший поиск бессмысленен
-            if (optimization != "O0" && alpha >= beta) {
-                // Возвращаем чуть лучший/худший счет для корректности отсечения
-                return (depth % 2 ? max_score + 1 : min_score - 1);
+            // Отсечение: если alpha >= beta, противник не допустит этой позиции
+            if (is_pruning && alpha >= beta) {
+                break;
             }
         }
         
-        // Возвращаем результат в зависимости от четности глубины
-        // Четные глубины - минимизируем, нечетные - максимизируем
-        return (depth % 2 ? max_score : min_score);
+        return best_score;
     }
 
-public:
-    // Перегруженная функция поиска ходов для определенного цвета на текущей доске
-    // Параметр color: цвет фигур для поиска (false = белые, true = черные)
-    void find_turns(const bool color)
+    // Перебор ходов узла, все дети которого - листья (BatchLeaves): дети упаковываются в arena->leaves
+    // и оцениваются одним векторным проходом, затем к оценкам применяется то же отсечение, что и в find_best_turns_rec
+    // Результат совпадает с поиском по одному ребенку (оценка листа не зависит от окна, поэтому повторный поиск PVS не нужен)
+    int search_leaves(const BOARD_T &mtx, const bool color, const size_t depth, int alpha, const int beta)
     {
-        find_turns(color, board->get_board());
+        const move_list &turns_now = arena->turns[depth];
+        fill_leaf_batch(pack_position(mtx, color, 0), turns_now, arena->leaves);
+        score_leaf_batch(arena->leaves, 100, 100 * (is_potential ? 5 : 4), (is_potential ? 5 : 0), arena->leaf_scores);
+        arena->pv_size[depth + 1] = 0;
+        const int leaf_depth = int(depth) + 1;
+        int best_score = -INF;
+        for (size_t i = 0; i < turns_now.size(); ++i)
+        {
+            ++nodes;
+            // Оценка хода - оценка листа с точки зрения противника с обратным знаком
+            int score;
+            if (!arena->leaves.white[i])
+                score = (color ? INF - leaf_depth : -INF + leaf_depth);
+            else if (!arena->leaves.black[i])
+                score = (color ? -INF + leaf_depth : INF - leaf_depth);
+            else
+                score = (color ? -arena->leaf_scores[i] : arena->leaf_scores[i]);
+            if (score > best_score)
+            {
+                best_score = score;
+                arena->pv[depth][0] = turns_now[i];
+                arena->pv_size[depth] = 1;
+            }
+            alpha = max(alpha, best_score);
+            if (is_pruning && alpha >= beta)
+                break;
+        }
+        if (is_stopped())
+            return 0;
+        return best_score;
     }
 
-    // Перегруженная функция поиска ходов для конкретной фигуры на текущей доске
-    // Параметры x, y: координаты фигуры на доске
-    void find_turns(const POS_T x, const POS_T y)
+    // Оценка хода turn с точки зрения сделавшей его стороны color в окне (alpha, beta)
+    // Поиск главного варианта (PVS): все ходы, кроме первого, сначала проверяются нулевым окном (alpha, alpha + 1),
+    // которое дешево доказывает, что ход не лучше уже найденного; если это не так, ход ищется заново с полным окном
+    int search_turn(const BOARD_T &mtx, const bool color, const size_t depth, const eval_acc &acc, const full_move &turn,
+                    const bool is_first, const int alpha, const int beta)
     {
-        find_turns(x, y, board->get_board());
+        const BOARD_T new_mtx = make_move(mtx, turn);
+        eval_acc new_acc = acc;
+        if (is_weights)
+            evaluator.update(new_acc, mtx, turn);
+        if (is_nnue)
+        {
+            arena->nnue[depth + 1] = arena->nnue[depth];
+            network->update(arena->nnue[depth + 1], mtx, turn);
+        }
+        if (eval_cache)
+            arena->hash[depth + 1] = zobrist_update(arena->hash[depth], mtx, turn);
+        if (is_first || !is_pruning || beta - alpha <= 1)
+            return -find_best_turns_rec(new_mtx, !color, depth + 1, new_acc, -beta, -alpha);
+        const int score = -find_best_turns_rec(new_mtx, !color, depth + 1, new_acc, -alpha - 1, -alpha);
+        if (score <= alpha || score >= beta)
+            return score;
+        return -find_best_turns_rec(new_mtx, !color, depth + 1, new_acc, -beta, -alpha);
     }
 
-private:
+    // Проверяет, нужно ли прервать поиск: выставлен внешний флаг остановки или истекло время
+    // Время проверяется раз в 1024 позиции, чтобы не замедлять перебор
+    // (счетчик позиций может вырасти сразу на много при пакетной оценке листьев, поэтому сравнивается с прошлой проверкой)
+    bool is_stopped()
+    {
+        if (aborted)
+            return true;
+        if (stop_flag && stop_flag->load(memory_order_relaxed))
+            aborted = true;
+        else if (has_node_limit && nodes >= node_limit)
+            aborted = true;
+        else if ((has_deadline || nps_limit) && nodes - checked_nodes >= 1024)
+        {
+            checked_nodes = nodes;
+            auto now = chrono::steady_clock::now();
+            // Ограничение скорости: поиск ждет, пока время с начала не станет не меньше nodes / nps_limit
+            if (nps_limit)
+            {
+                auto due = search_start + chrono::microseconds(nodes * 1000000 / nps_limit);
+                if (has_deadline)
+                    due = min(due, deadline);
+                if (now < due)
+                {
+                    this_thread::sleep_until(due);
+                    now = due;
+                }
+            }
+            aborted = (has_deadline && now >= deadline);
+        }
+        return aborted;
+    }
+
+public:
+    // Генератор ходов - чистые функции без общего состояния: результат записывается в буфер вызывающего,
+    // поэтому их можно вызывать одновременно из разных потоков (параллельный поиск, пакетный анализ)
+    // Параметр res: vector<move_pos> или turn_list (для find_moves - move_list), прежнее содержимое удаляется
+
     // Основная функция поиска всех доступных ходов для определенного цвета
     // Параметр color: цвет фигур (false = белые, true = черные)
-    // Параметр mtx: состояние доски в виде матрицы
-    void find_turns(const bool color, const vector<vector<POS_T>> &mtx)
+    // Параметр mtx: состояние доски в виде матрицы (vector<vector<POS_T>> или BOARD_T)
+    // Возвращает true, если ходы - взятия (в шашках взятия обязательны, обычных ходов тогда в res нет)
+    template <class Matrix, class List> static bool find_turns(const bool color, const Matrix &mtx, List &res)
     {
-        vector<move_pos> res_turns;
+        res.clear();
         bool have_beats_before = false;  // Флаг наличия взятий
         
         // Проходим по всем клеткам доски 8x8
@@ -275,38 +715,76 @@ private:
                 // Проверяем, есть ли на клетке фигура нужного цвета
                 if (mtx[i][j] && mtx[i][j] % 2 != color)
                 {
-                    // Ищем возможные ходы для этой фигуры
-                    find_turns(i, j, mtx);
-                    
-                    // Если найдены взятия, очищаем список обычных ходов
-                    if (have_beats && !have_beats_before)
+                    const size_t start = res.size();
+                    // Ищем возможные ходы для этой фигуры (после первого взятия - только взятия)
+                    // Если найдены первые взятия, удаляем найденные ранее обычные ходы
+                    if (add_turns(i, j, mtx, res, have_beats_before) && !have_beats_before)
                     {
                         have_beats_before = true;
-                        res_turns.clear();  // В шашках взятия обязательны
-                    }
-                    
-                    // Добавляем найденные ходы в результат
-                    if ((have_beats_before && have_beats) || !have_beats_before)
-                    {
-                        res_turns.insert(res_turns.end(), turns.begin(), turns.end());
+                        res.erase(res.begin(), res.begin() + start);  // В шашках взятия обязательны
                     }
                 }
             }
         }
-        turns = res_turns;
-        
-        // Перемешиваем ходы для случайности (если включено в настройках)
-        shuffle(turns.begin(), turns.end(), rand_eng);
-        have_beats = have_beats_before;
+        return have_beats_before;
     }
 
     // Функция поиска всех возможных ходов для конкретной фигуры
     // Параметры x, y: координаты фигуры на доске
     // Параметр mtx: состояние доски в виде матрицы
-    void find_turns(const POS_T x, const POS_T y, const vector<vector<POS_T>> &mtx)
+    // Возвращает true, если ходы - взятия
+    template <class Matrix, class List> static bool find_turns(const POS_T x, const POS_T y, const Matrix &mtx, List &res)
+    {
+        res.clear();
+        return add_turns(x, y, mtx, res, false);
+    }
+
+    // Генерирует все полные ходы цвета color: обычные ходы или серии взятий целиком (для поиска)
+    // Серии одной фигуры с одинаковым результатом (конечное поле и побитые фигуры), пройденные разными путями,
+    // записываются один раз
+    // Возвращает true, если ходы - взятия
+    template <class Matrix> static bool find_moves(const bool color, const Matrix &mtx, move_list &res)
+    {
+        res.clear();
+        BOARD_T cur_mtx;
+        for (POS_T i = 0; i < 8; ++i)
+            for (POS_T j = 0; j < 8; ++j)
+                cur_mtx[i][j] = mtx[i][j];
+        turn_list first;
+        const bool have_beats = find_turns(color, cur_mtx, first);
+        full_move cur;
+        for (auto turn : first)
+        {
+            cur.x = turn.x;
+            cur.y = turn.y;
+            if (have_beats)
+                add_series(cur_mtx, turn, cur_mtx[turn.x][turn.y], cur, res);
+            else
+            {
+                cur.x2 = turn.x2;
+                cur.y2 = turn.y2;
+                cur.is_promotion = ((cur_mtx[turn.x][turn.y] == 1 && turn.x2 == 0) || (cur_mtx[turn.x][turn.y] == 2 && turn.x2 == 7));
+                res.push_back(cur);
+            }
+        }
+        return have_beats;
+    }
+
+  private:
+    // Записывает ошибку настройки в log.txt (как ошибки загрузки партии в Game.h)
+    static void log_error(const string &message)
     {
-        turns.clear();          // Очищаем предыдущие результаты
-        have_beats = false;     // Сброс флага взятий
+        ofstream fout(project_path + "log.txt", ios_base::app);
+        fout << "Error: " << message << "\n";
+    }
+
+    // Генерирует все возможные ходы фигуры x, y и дописывает их в res
+    // Параметр only_beats: искать только взятия
+    // Возвращает true, если найдены взятия (тогда обычные ходы фигуры не добавляются)
+    template <class Matrix, class List>
+    static bool add_turns(const POS_T x, const POS_T y, const Matrix &mtx, List &res, const bool only_beats)
+    {
+        const size_t start = res.size();
         POS_T type = mtx[x][y]; // Тип фигуры (1=белая шашка, 2=черная шашка, 3=белая дамка, 4=черная дамка)
         
         // Сначала проверяем возможности взятия (приоритетны в шашках)
@@ -324,7 +802,7 @@ private:
                     POS_T xb = (x + i) / 2, yb = (y + j) / 2;
                     if (mtx[i][j] || !mtx[xb][yb] || mtx[xb][yb] % 2 == type % 2)
                         continue;
-                    turns.emplace_back(x, y, i, j, xb, yb);
+                    res.emplace_back(x, y, i, j, xb, yb);
                 }
             }
             break;
@@ -348,7 +826,7 @@ private:
                         }
                         if (xb != -1 && xb != i2)
                         {
-                            turns.emplace_back(x, y, i2, j2, xb, yb);
+                            res.emplace_back(x, y, i2, j2, xb, yb);
                         }
                     }
                 }
@@ -356,11 +834,10 @@ private:
             break;
         }
         // check other turns
-        if (!turns.empty())
-        {
-            have_beats = true;
-            return;
-        }
+        if (res.size() != start)
+            return true;
+        if (only_beats)
+            return false;
         switch (type)
         {
         case 1:
@@ -372,7 +849,7 @@ private:
                 {
                     if (i < 0 || i > 7 || j < 0 || j > 7 || mtx[i][j])
                         continue;
-                    turns.emplace_back(x, y, i, j);
+                    res.emplace_back(x, y, i, j);
                 }
                 break;
             }
@@ -386,25 +863,84 @@ private:
                     {
                         if (mtx[i2][j2])
                             break;
-                        turns.emplace_back(x, y, i2, j2);
+                        res.emplace_back(x, y, i2, j2);
                     }
                 }
             }
             break;
         }
+        return false;
     }
 
+
+    // Продолжает серию взятий cur элементарным взятием turn и дописывает в res все серии, которые из нее получаются
+    // Параметр type: фигура, начавшая серию (чтобы заметить превращение в дамку)
+    static void add_series(const BOARD_T &mtx, const move_pos &turn, const POS_T type, full_move &cur, move_list &res)
+    {
+        const BOARD_T new_mtx = make_turn(mtx, turn);
+        cur.path[cur.size] = uint8_t(turn.x2 * 8 + turn.y2);
+        cur.beat_path[cur.size] = uint8_t(turn.xb * 8 + turn.yb);
+        ++cur.size;
+        turn_list next;
+        if (add_turns(turn.x2, turn.y2, new_mtx, next, true))
+        {
+            for (auto next_turn : next)
+                add_series(new_mtx, next_turn, type, cur, res);
+        }
+        else
+        {
+            // Серия закончилась
+            cur.x2 = turn.x2;
+            cur.y2 = turn.y2;
+            cur.is_promotion = (new_mtx[turn.x2][turn.y2] != type);
+            cur.beats = 0;
+            for (uint8_t i = 0; i < cur.size; ++i)
+                cur.beats |= uint32_t(1) << (cur.beat_path[i] / 2);
+            bool is_new = (res.size() < MAX_TURNS);
+            for (size_t i = 0; is_new && i < res.size(); ++i)
+                is_new = !res[i].is_same_result(cur);
+            if (is_new)
+                res.push_back(cur);
+        }
+        --cur.size;
+    }
   public:
-    vector<move_pos> turns;    // Список всех найденных возможных ходов
-    bool have_beats;           // Флаг наличия обязательных взятий среди ходов
-    int Max_depth;             // Максимальная глубина поиска для алгоритма минимакс
+    int Max_depth;             // Уровень бота: глубина поиска в полуходах равна Max_depth + 1
+    int last_score = 0;        // Оценка хода, найденного последним вызовом find_best_turns (с точки зрения бота)
+    uint64_t nodes = 0;        // Счетчик просмотренных позиций с начала поиска (search)
+    const atomic<bool> *stop_flag = nullptr;  // Внешний флаг остановки поиска (команда stop)
+    size_t multi_pv = 1;       // Сколько лучших ходов анализирует search (режим multi-PV)
+    uint64_t nps_limit = 0;    // Не больше стольких позиций в секунду (NodesPerSecond, 0 - без ограничения)
+    uint64_t full_window_nodes = 0;    // Позиций в поиске с полным окном (считается в find_best_turns при AspirationStats)
+    uint64_t aspiration_researches = 0; // Сколько раз окно стремления пришлось расширять
+    uint64_t cache_probes = 0;         // Обращений к кэшу оценок (EvalCacheMB > 0) с создания Logic
+    uint64_t cache_hits = 0;           // Из них найдено в кэше
+    uint64_t analysis_hits = 0;        // Ходов, взятых из кэша анализа (AnalysisCacheFile) с создания Logic
 
   private:
     default_random_engine rand_eng;    // Генератор случайных чисел для перемешивания ходов
-    string scoring_mode;               // Режим оценки позиции ("NumberAndPotential" и др.)
+    string scoring_mode;               // Режим оценки позиции ("NumberOnly", "NumberAndPotential", "Weights", "Nnue")
     string optimization;               // Уровень оптимизации алгоритма (O0, O1, O2, O3)
-    vector<move_pos> next_move;        // Массив лучших ходов для каждого состояния
-    vector<int> next_best_state;       // Массив ссылок на следующие лучшие состояния
-    Board *board;                      // Указатель на игровую доску
+    bool is_potential;                 // Учитывать продвижение шашек (scoring_mode == "NumberAndPotential")
+    bool is_weights;                   // Оценка по настраиваемым весам (scoring_mode == "Weights")
+    bool is_nnue;                      // Оценка нейросетью (scoring_mode == "Nnue")
+    Evaluator evaluator;               // Оценочная функция режима Weights
+    shared_ptr<Nnue> network;          // Нейросеть режима Nnue (при поиске только читается)
+    shared_ptr<EvalCache> eval_cache;  // Кэш оценок листьев (nullptr, если выключен)
+    shared_ptr<AnalysisCache> analysis_cache;  // Кэш результатов поиска на диске (nullptr, если выключен)
+    bool batch_leaves;                 // Оценивать детей узла перед листьями пачкой (BatchLeaves, см. search_leaves)
+    bool is_pruning;                   // Альфа-бета отсечение включено (все уровни, кроме O0)
+    int aspiration_window;             // Полуширина окна стремления (0 - поиск всегда с полным окном)
+    bool aspiration_stats;             // Сравнивать каждый поиск с поиском с полным окном (AspirationStats)
+    int prev_score[2] = {0, 0};        // Оценка последнего найденного хода для каждого цвета
+    bool has_prev_score[2] = {false, false};
+    bool aborted = false;              // Поиск прерван, результат текущей итерации недостоверен
+    bool has_deadline = false;         // Задано ли ограничение по времени
+    bool has_node_limit = false;       // Задан ли бюджет позиций (search, начиная с уровня 1)
+    uint64_t node_limit = 0;           // Бюджет позиций
+    uint64_t checked_nodes = 0;        // Значение nodes при последней проверке времени
+    chrono::steady_clock::time_point search_start;  // Начало поиска (для ограничения скорости)
+    chrono::steady_clock::time_point deadline;  // Момент, когда поиск должен остановиться
     Config *config;                    // Указатель на конфигурацию игры
+    unique_ptr<search_arena> arena;    // Память поиска (буферы ходов и главных вариантов), своя у каждого экземпляра
 };
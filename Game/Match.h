@@ -0,0 +1,91 @@
+#pragma once
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include "../Models/Search.h"
+#include "Config.h"
+#include "Logic.h"
+#include "Mcts.h"
+#include "Notation.h"
+
+using namespace std;
+
+// Партии без графики между ботом альфа-бета (Logic) и ботом MCTS (Mcts) для сравнения их силы
+// Дебют каждой пары партий - несколько случайных полуходов из начальной позиции, в паре цвета меняются
+class Match
+{
+  public:
+    // Параметр ab_limits: уровень или бюджет позиций бота альфа-бета; число партий и потоки MCTS - в настройках Mcts
+    Match(Config *config, const search_limits &ab_limits, const int random_plies, const int max_plies)
+        : config(config), ab_limits(ab_limits), random_plies(random_plies), max_plies(max_plies)
+    {
+    }
+
+    // Результат партии для бота MCTS: 2 - выигрыш, 1 - ничья (max_plies полуходов без результата), 0 - проигрыш
+    // Параметр index: номер партии (пара партий 2k, 2k + 1 играется из одного дебюта, MCTS - белыми в четной)
+    int play(const size_t index)
+    {
+        Logic logic(config);
+        Mcts mcts(config);
+        vector<vector<POS_T>> mtx;
+        bool color;
+        parse_fen(start_fen, mtx, color);
+        const bool mcts_color = (index % 2 == 1);
+
+        // Случайный дебют
+        mt19937 rng(unsigned(index / 2));
+        move_list moves;
+        int ply = 0;
+        for (; ply < random_plies; ++ply)
+        {
+            Logic::find_moves(color, mtx, moves);
+            if (moves.empty())
+                return (color == mcts_color ? 0 : 2);
+            vector<move_pos> turns;
+            moves[rng() % moves.size()].to_turns(turns);
+            mtx = apply(mtx, turns);
+            color = !color;
+        }
+        for (; ply < max_plies; ++ply)
+        {
+            Logic::find_moves(color, mtx, moves);
+            if (moves.empty())
+                return (color == mcts_color ? 0 : 2);
+            auto start = chrono::steady_clock::now();
+            vector<move_pos> turns;
+            if (color == mcts_color)
+                turns = mcts.find_best_turns(mtx, color);
+            else
+            {
+                turns = logic.search(mtx, color, ab_limits);
+                ab_nodes += logic.nodes;
+            }
+            const double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+            (color == mcts_color ? mcts_ms : ab_ms) += ms;
+            ++(color == mcts_color ? mcts_moves : ab_moves);
+            mtx = apply(mtx, turns);
+            color = !color;
+        }
+        return 1;
+    }
+
+  private:
+    static vector<vector<POS_T>> apply(vector<vector<POS_T>> mtx, const vector<move_pos> &turns)
+    {
+        for (auto &turn : turns)
+            mtx = Logic::make_turn(mtx, turn);
+        return mtx;
+    }
+
+  public:
+    double ab_ms = 0, mcts_ms = 0;          // Время на ходы ботов с создания Match
+    uint64_t ab_moves = 0, mcts_moves = 0;  // Количество ходов ботов
+    uint64_t ab_nodes = 0;                  // Позиций, просмотренных ботом альфа-бета
+
+  private:
+    Config *config;
+    search_limits ab_limits;
+    int random_plies;
+    int max_plies;
+};
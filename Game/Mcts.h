@@ -0,0 +1,274 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "../Models/Mcts.h"
+#include "../Models/Move.h"
+#include "Config.h"
+#include "Logic.h"
+
+using namespace std;
+
+// Поиск Монте-Карло по дереву (MCTS) с формулой UCT - второй тип бота (BotType = "Mcts")
+// Каждая итерация: спуск по дереву по UCT, раскрытие листа, случайная партия из него, обновление счетчиков на пути
+// Несколько потоков растят одно дерево (tree parallelism): потоки, спускающиеся через узел, временно
+// считаются его проигрышами (virtual loss), поэтому одновременные спуски расходятся по разным ветвям
+// Узлы берутся из пула фиксированного размера (MctsPoolMB); когда пул заполнен, дерево перестает расти,
+// а итерации продолжаются партиями из листьев
+class Mcts
+{
+  public:
+    Mcts(Config *config) : config(config)
+    {
+        auto value = (*config)("Bot", "MctsPlayouts");
+        playouts = (value.is_number() ? max(1, int(value)) : 20000);
+        value = (*config)("Bot", "MctsThreads");
+        const unsigned threads = (value.is_number() ? unsigned(max(0, int(value))) : 1u);
+        threads_count = threads ? threads : max(1u, thread::hardware_concurrency());
+        value = (*config)("Bot", "MctsPolicy");
+        policy = (value.is_string() && string(value) == "Random" ? PlayoutPolicy::RANDOM : PlayoutPolicy::CAPTURES);
+        value = (*config)("Bot", "MctsExploration");
+        exploration = (value.is_number() ? double(value) : 1.0);
+        value = (*config)("Bot", "MctsPoolMB");
+        const size_t megabytes = (value.is_number() ? size_t(max(1, int(value))) : 64);
+        pool_size = max(size_t(MAX_TURNS + 1), megabytes * 1024 * 1024 / sizeof(mcts_node));
+        pool = make_unique<mcts_node[]>(pool_size);
+        value = (*config)("Bot", "NoRandom");
+        seed = (value.is_boolean() && bool(value) ? 0u : unsigned(time(0)));
+    }
+
+    // Ищет ход бота цвета color в позиции mtx: playouts случайных партий (не дольше movetime_ms, если задано)
+    // Возвращает серию ходов с наибольшим числом посещений
+    vector<move_pos> find_best_turns(const vector<vector<POS_T>> &mtx, const bool color, const int movetime_ms = -1)
+    {
+        for (POS_T i = 0; i < 8; ++i)
+            for (POS_T j = 0; j < 8; ++j)
+                root_mtx[i][j] = mtx[i][j];
+        root_color = color;
+        pool_used = 1;
+        reset(pool[0]);
+        iterations = 0;
+        has_deadline = (movetime_ms >= 0);
+        deadline = chrono::steady_clock::now() + chrono::milliseconds(max(0, movetime_ms));
+
+        vector<thread> workers;
+        for (unsigned i = 1; i < threads_count; ++i)
+            workers.emplace_back(&Mcts::worker, this, seed + i);
+        worker(seed);
+        for (auto &th : workers)
+            th.join();
+        seed += threads_count;
+
+        // Лучший ход - самый посещаемый
+        vector<move_pos> res;
+        const mcts_node &root = pool[0];
+        if (root.state.load() != 2 || !root.child_count.load())
+            return res;
+        uint32_t best = root.first_child.load();
+        for (uint32_t i = root.first_child.load(); i < root.first_child.load() + root.child_count.load(); ++i)
+        {
+            if (pool[i].visits.load() > pool[best].visits.load())
+                best = i;
+        }
+        pool[best].move.to_turns(res);
+        const uint32_t visits = max(1u, pool[best].visits.load());
+        win_rate = double(pool[best].score.load()) / (2.0 * visits);
+        return res;
+    }
+
+  private:
+    void reset(mcts_node &node)
+    {
+        node.visits.store(0, memory_order_relaxed);
+        node.virtual_loss.store(0, memory_order_relaxed);
+        node.score.store(0, memory_order_relaxed);
+        node.first_child.store(0, memory_order_relaxed);
+        node.child_count.store(0, memory_order_relaxed);
+        node.state.store(0, memory_order_relaxed);
+    }
+
+    // Поток поиска: итерации, пока не набрано playouts партий на всех или не истекло время
+    void worker(const unsigned thread_seed)
+    {
+        default_random_engine rng(thread_seed);
+        vector<uint32_t> path;
+        move_list moves;
+        while (iterations.fetch_add(1, memory_order_relaxed) < uint64_t(playouts))
+        {
+            if (has_deadline && chrono::steady_clock::now() >= deadline)
+                break;
+            iterate(rng, path, moves);
+        }
+    }
+
+    // Одна итерация MCTS
+    void iterate(default_random_engine &rng, vector<uint32_t> &path, move_list &moves)
+    {
+        BOARD_T mtx = root_mtx;
+        bool color = root_color;
+        path.clear();
+        path.push_back(0);
+        uint32_t cur = 0;
+        // Спуск по раскрытым узлам
+        while (pool[cur].state.load(memory_order_acquire) == 2 && pool[cur].child_count.load(memory_order_relaxed))
+        {
+            cur = select_child(pool[cur]);
+            pool[cur].virtual_loss.fetch_add(1, memory_order_relaxed);
+            mtx = Logic::make_move(mtx, pool[cur].move);
+            color = !color;
+            path.push_back(cur);
+        }
+        // Лист: раскрываем (если его не раскрывает другой поток) и играем случайную партию из одного из детей
+        int result;  // Для стороны color: 2 - выигрыш, 1 - ничья, 0 - проигрыш
+        mcts_node &leaf = pool[cur];
+        // Состояние перечитывается: узел мог раскрыть другой поток после выхода из спуска, тогда у него есть дети
+        // и из него играется случайная партия (обмен ниже не удается); конец партии - раскрыт и без детей
+        if (leaf.state.load(memory_order_acquire) == 2 && !leaf.child_count.load(memory_order_relaxed))
+            result = 0;  // Конец партии: у ходящей стороны нет ходов
+        else
+        {
+            uint8_t expected = 0;
+            if (leaf.state.compare_exchange_strong(expected, 1, memory_order_acq_rel) && expand(leaf, mtx, color, moves))
+            {
+                if (!leaf.child_count.load(memory_order_relaxed))
+                    result = 0;
+                else
+                {
+                    cur = leaf.first_child.load(memory_order_relaxed) +
+                          uint32_t(rng() % leaf.child_count.load(memory_order_relaxed));
+                    pool[cur].virtual_loss.fetch_add(1, memory_order_relaxed);
+                    mtx = Logic::make_move(mtx, pool[cur].move);
+                    color = !color;
+                    path.push_back(cur);
+                    result = playout(mtx, color, rng, moves);
+                }
+            }
+            else
+                result = playout(mtx, color, rng, moves);
+        }
+        // Обратное распространение: результат узла - для стороны, сделавшей его ход (противника ходящей в нем)
+        for (size_t i = path.size(); i-- > 0;)
+        {
+            result = 2 - result;
+            mcts_node &node = pool[path[i]];
+            node.score.fetch_add(uint64_t(result), memory_order_relaxed);
+            node.visits.fetch_add(1, memory_order_relaxed);
+            if (i)
+                node.virtual_loss.fetch_sub(1, memory_order_relaxed);
+        }
+    }
+
+    // Ребенок с наибольшим UCT: доля очков + exploration * sqrt(ln N / n), виртуальные проигрыши входят в n
+    // Непосещенные дети выбираются первыми
+    uint32_t select_child(const mcts_node &node) const
+    {
+        const uint32_t first = node.first_child.load(memory_order_relaxed);
+        const uint32_t count = node.child_count.load(memory_order_relaxed);
+        const double log_parent = log(double(node.visits.load(memory_order_relaxed) + 1));
+        uint32_t best = first;
+        double best_value = -1;
+        for (uint32_t i = first; i < first + count; ++i)
+        {
+            const uint32_t n = pool[i].visits.load(memory_order_relaxed) + pool[i].virtual_loss.load(memory_order_relaxed);
+            if (!n)
+                return i;
+            const double value = double(pool[i].score.load(memory_order_relaxed)) / (2.0 * n) +
+                                 exploration * sqrt(log_parent / n);
+            if (value > best_value)
+            {
+                best_value = value;
+                best = i;
+            }
+        }
+        return best;
+    }
+
+    // Создает детей узла node (позиция mtx, ходит color); возвращает false, если пул заполнен
+    bool expand(mcts_node &node, const BOARD_T &mtx, const bool color, move_list &moves)
+    {
+        Logic::find_moves(color, mtx, moves);
+        const size_t first = pool_used.fetch_add(moves.size(), memory_order_relaxed);
+        if (first + moves.size() > pool_size)
+        {
+            node.state.store(0, memory_order_release);
+            return false;
+        }
+        for (size_t i = 0; i < moves.size(); ++i)
+        {
+            reset(pool[first + i]);
+            pool[first + i].move = moves[i];
+        }
+        node.first_child.store(uint32_t(first), memory_order_relaxed);
+        node.child_count.store(uint32_t(moves.size()), memory_order_relaxed);
+        node.state.store(2, memory_order_release);
+        return true;
+    }
+
+    // Случайная партия из позиции mtx (ходит color) не длиннее MAX_PLAYOUT_PLIES полуходов
+    // Возвращает результат для color: 2 - выигрыш, 1 - ничья, 0 - проигрыш; недоигранная партия
+    // присуждается по материалу (дамка - три шашки)
+    int playout(BOARD_T mtx, bool color, default_random_engine &rng, move_list &moves) const
+    {
+        const bool start_color = color;
+        for (int ply = 0; ply < MAX_PLAYOUT_PLIES; ++ply)
+        {
+            Logic::find_moves(color, mtx, moves);
+            if (moves.empty())
+                return (color == start_color ? 0 : 2);
+            mtx = Logic::make_move(mtx, moves[pick_move(moves, rng)]);
+            color = !color;
+        }
+        int material = 0;
+        for (POS_T i = 0; i < 8; ++i)
+            for (POS_T j = 0; j < 8; ++j)
+                if (mtx[i][j])
+                    material += (mtx[i][j] > 2 ? 3 : 1) * (mtx[i][j] % 2 ? 1 : -1);
+        if (start_color)
+            material = -material;
+        return (material > 0 ? 2 : material < 0 ? 0 : 1);
+    }
+
+    // Выбор хода случайной партии: равновероятно или с весом 1 + 3 * взятия + 2 * превращение (CAPTURES)
+    size_t pick_move(const move_list &moves, default_random_engine &rng) const
+    {
+        if (policy == PlayoutPolicy::RANDOM || moves.size() == 1)
+            return rng() % moves.size();
+        int weights[MAX_TURNS], total = 0;
+        for (size_t i = 0; i < moves.size(); ++i)
+        {
+            weights[i] = 1 + 3 * moves[i].size + 2 * moves[i].is_promotion;
+            total += weights[i];
+        }
+        int r = int(rng() % unsigned(total));
+        size_t i = 0;
+        while (r >= weights[i])
+            r -= weights[i++];
+        return i;
+    }
+
+  public:
+    int playouts;               // Случайных партий на ход (MctsPlayouts)
+    unsigned threads_count;     // Потоков поиска (MctsThreads, 0 - по числу ядер)
+    double win_rate = 0;        // Доля очков выбранного хода в последнем поиске (выигрыш - 1, ничья - 0.5)
+
+    static const int MAX_PLAYOUT_PLIES = 150;
+
+  private:
+    Config *config;
+    PlayoutPolicy policy;
+    double exploration;                  // Коэффициент исследования в UCT (MctsExploration)
+    unique_ptr<mcts_node[]> pool;        // Пул узлов, pool[0] - корень
+    size_t pool_size;
+    atomic<size_t> pool_used{0};
+    atomic<uint64_t> iterations{0};      // Начатые итерации текущего поиска
+    unsigned seed;                       // Зерно генераторов потоков (0 при NoRandom)
+    BOARD_T root_mtx;
+    bool root_color = false;
+    bool has_deadline = false;
+    chrono::steady_clock::time_point deadline;
+};
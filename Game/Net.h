@@ -0,0 +1,279 @@
+#pragma once
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#ifndef _WIN32
+    #include <fcntl.h>
+    #include <netdb.h>
+    #include <netinet/in.h>
+    #include <netinet/tcp.h>
+    #include <signal.h>
+    #include <sys/socket.h>
+    #include <sys/un.h>
+    #include <unistd.h>
+#endif
+
+using namespace std;
+
+// Сокеты для распределенной работы (Game/Coordinator.h, Game/Worker.h): TCP или Unix-сокет, сообщения -
+// строки JSON, разделенные '\n'. Адрес: "unix:<путь>" или "<хост>:<порт>" (по умолчанию 127.0.0.1:5555)
+// Только POSIX: под Windows конструкторы бросают runtime_error
+
+const string default_address = "127.0.0.1:5555";
+
+// Соединение: отправка строк и чтение целых строк из буфера приема
+// Блокирующее по умолчанию; после set_nonblocking строки отправляются через буфер (queue_line, flush)
+class LineSocket
+{
+  public:
+    explicit LineSocket(const int fd = -1) : fd(fd)
+    {
+    }
+
+    LineSocket(const LineSocket &) = delete;
+    LineSocket &operator=(const LineSocket &) = delete;
+
+    LineSocket(LineSocket &&other) noexcept : fd(other.fd), input(move(other.input)), output(move(other.output))
+    {
+        other.fd = -1;
+    }
+
+    LineSocket &operator=(LineSocket &&other) noexcept
+    {
+        if (this != &other)
+        {
+            close_socket();
+            fd = other.fd;
+            input = move(other.input);
+            output = move(other.output);
+            other.fd = -1;
+        }
+        return *this;
+    }
+
+    ~LineSocket()
+    {
+        close_socket();
+    }
+
+    // Подключается к address; бросает runtime_error при ошибке
+    static LineSocket connect_to(const string &address)
+    {
+#ifdef _WIN32
+        throw runtime_error("sockets are not supported on Windows");
+#else
+        if (address.rfind("unix:", 0) == 0)
+        {
+            sockaddr_un addr = unix_address(address.substr(5));
+            LineSocket sock(socket(AF_UNIX, SOCK_STREAM, 0));
+            if (sock.fd < 0 || connect(sock.fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0)
+                throw runtime_error("can't connect to " + address);
+            return sock;
+        }
+        addrinfo *info = resolve(address, false);
+        LineSocket sock(socket(info->ai_family, info->ai_socktype, info->ai_protocol));
+        const bool ok = (sock.fd >= 0 && connect(sock.fd, info->ai_addr, info->ai_addrlen) == 0);
+        freeaddrinfo(info);
+        if (!ok)
+            throw runtime_error("can't connect to " + address);
+        int one = 1;
+        setsockopt(sock.fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        return sock;
+#endif
+    }
+
+    // Открывает прослушивающий сокет на address; бросает runtime_error при ошибке
+    static LineSocket listen_on(const string &address)
+    {
+#ifdef _WIN32
+        throw runtime_error("sockets are not supported on Windows");
+#else
+        // Запись в закрытое соединение (упавший рабочий) не должна завершать процесс
+        signal(SIGPIPE, SIG_IGN);
+        if (address.rfind("unix:", 0) == 0)
+        {
+            sockaddr_un addr = unix_address(address.substr(5));
+            unlink(addr.sun_path);
+            LineSocket sock(socket(AF_UNIX, SOCK_STREAM, 0));
+            if (sock.fd < 0 || bind(sock.fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0 ||
+                listen(sock.fd, 64) != 0)
+                throw runtime_error("can't listen on " + address);
+            return sock;
+        }
+        addrinfo *info = resolve(address, true);
+        LineSocket sock(socket(info->ai_family, info->ai_socktype, info->ai_protocol));
+        int one = 1;
+        if (sock.fd >= 0)
+            setsockopt(sock.fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        const bool ok = (sock.fd >= 0 && bind(sock.fd, info->ai_addr, info->ai_addrlen) == 0 && listen(sock.fd, 64) == 0);
+        freeaddrinfo(info);
+        if (!ok)
+            throw runtime_error("can't listen on " + address);
+        return sock;
+#endif
+    }
+
+    // Принимает соединение (сокет должен быть прослушивающим)
+    LineSocket accept_client() const
+    {
+#ifdef _WIN32
+        return LineSocket();
+#else
+        LineSocket client(accept(fd, nullptr, nullptr));
+        if (client.fd >= 0)
+        {
+            int one = 1;
+            setsockopt(client.fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        }
+        return client;
+#endif
+    }
+
+    // Отправляет строку (с '\n'); возвращает false, если соединение разорвано
+    bool send_line(const string &line)
+    {
+#ifdef _WIN32
+        return false;
+#else
+        const string data = line + '\n';
+        size_t sent = 0;
+        while (sent < data.size())
+        {
+            const ssize_t res = ::send(fd, data.data() + sent, data.size() - sent, 0);
+            if (res <= 0)
+                return false;
+            sent += size_t(res);
+        }
+        return true;
+#endif
+    }
+
+    // Переводит сокет в неблокирующий режим (для цикла poll)
+    void set_nonblocking()
+    {
+#ifndef _WIN32
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+#endif
+    }
+
+    // Добавляет строку (с '\n') в буфер отправки и отправляет, сколько примет сокет;
+    // возвращает false, если соединение разорвано. Остаток отправляет flush
+    bool queue_line(const string &line)
+    {
+        output += line;
+        output += '\n';
+        return flush();
+    }
+
+    // Отправляет данные из буфера отправки без ожидания; возвращает false, если соединение разорвано
+    bool flush()
+    {
+#ifdef _WIN32
+        return false;
+#else
+        size_t sent = 0;
+        while (sent < output.size())
+        {
+            const ssize_t res = ::send(fd, output.data() + sent, output.size() - sent, 0);
+            if (res < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR))
+                break;
+            if (res <= 0)
+                return false;
+            sent += size_t(res);
+        }
+        output.erase(0, sent);
+        return true;
+#endif
+    }
+
+    // Размер еще не отправленных данных
+    size_t pending() const
+    {
+        return output.size();
+    }
+
+    // Читает доступные данные (блокируется, если их нет и сокет блокирующий); возвращает false при закрытии соединения
+    bool receive()
+    {
+#ifdef _WIN32
+        return false;
+#else
+        char buffer[65536];
+        const ssize_t res = recv(fd, buffer, sizeof(buffer), 0);
+        if (res < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR))
+            return true;
+        if (res <= 0)
+            return false;
+        input.append(buffer, size_t(res));
+        return true;
+#endif
+    }
+
+    // Извлекает из буфера приема следующую целую строку; возвращает false, если ее еще нет
+    bool next_line(string &line)
+    {
+        const size_t end = input.find('\n');
+        if (end == string::npos)
+            return false;
+        line = input.substr(0, end);
+        input.erase(0, end + 1);
+        return true;
+    }
+
+    // Блокирующее чтение строки; возвращает false при закрытии соединения
+    bool read_line(string &line)
+    {
+        while (!next_line(line))
+        {
+            if (!receive())
+                return false;
+        }
+        return true;
+    }
+
+    void close_socket()
+    {
+#ifndef _WIN32
+        if (fd >= 0)
+            close(fd);
+#endif
+        fd = -1;
+    }
+
+    int fd;
+
+  private:
+#ifndef _WIN32
+    static sockaddr_un unix_address(const string &path)
+    {
+        sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(addr.sun_path))
+            throw runtime_error("socket path is too long: " + path);
+        strcpy(addr.sun_path, path.c_str());
+        return addr;
+    }
+
+    static addrinfo *resolve(const string &address, const bool passive)
+    {
+        const size_t colon = address.rfind(':');
+        if (colon == string::npos)
+            throw runtime_error("bad address " + address + " (host:port or unix:path expected)");
+        addrinfo hints;
+        memset(&hints, 0, sizeof(hints));
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        hints.ai_flags = (passive ? AI_PASSIVE : 0);
+        addrinfo *info = nullptr;
+        if (getaddrinfo(address.substr(0, colon).c_str(), address.substr(colon + 1).c_str(), &hints, &info) != 0 || !info)
+            throw runtime_error("can't resolve " + address);
+        return info;
+    }
+#endif
+
+    string input;   // Принятые, но еще не разобранные данные
+    string output;  // Строки queue_line, еще не принятые сокетом
+};
@@ -0,0 +1,292 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+// Векторные ядра выбираются при компиляции: AVX2 (-mavx2 / -march=native), SSE2 (любой x86-64) или скалярные
+// NNUE_SCALAR принудительно включает скалярные ядра (для проверки и других архитектур)
+#if defined(__AVX2__) && !defined(NNUE_SCALAR)
+    #define NNUE_AVX2
+    #include <immintrin.h>
+#elif (defined(__SSE2__) || defined(_M_X64)) && !defined(NNUE_SCALAR)
+    #define NNUE_SSE2
+    #include <emmintrin.h>
+#endif
+
+#include "../Models/Move.h"
+#include "../Models/Nnue.h"
+#include "../Models/Packed.h"
+#include "Evaluator.h"
+
+using namespace std;
+
+// Небольшая нейросеть оценки в стиле NNUE (BotScoringType = "Nnue")
+// Устройство: входы "фигура-поле" с точки зрения каждой стороны -> первый слой NNUE_HIDDEN нейронов на сторону
+// (накопитель nnue_acc, обновляется по ходу) -> ограниченный ReLU [0, 127] -> второй слой NNUE_L2 нейронов
+// (int8 веса) -> ограниченный ReLU -> выход; к выходу прибавляется линейная часть "фигура-поле" (psqt),
+// набор которой выбирается по количеству фигур на доске
+// Все вычисления целочисленные; оценка в сотых долях шашки с точки зрения ходящей стороны
+class Nnue
+{
+  public:
+    // Сеть без скрытых слоев, линейная часть которой равна оценке "фигура-поле" из evaluator
+    // (материал, продвижение, первый ряд, центр), - используется, пока нет обученной сети
+    void init_from(const Evaluator &evaluator)
+    {
+        memset(b1, 0, sizeof(b1));
+        memset(w1, 0, sizeof(w1));
+        memset(b2, 0, sizeof(b2));
+        memset(w2, 0, sizeof(w2));
+        memset(w3, 0, sizeof(w3));
+        b3 = 0;
+        // Своя шашка, своя дамка, чужая шашка, чужая дамка с точки зрения белых
+        const POS_T kind_type[4] = {1, 3, 2, 4};
+        for (int kind = 0; kind < 4; ++kind)
+        {
+            for (int sq = 0; sq < 32; ++sq)
+            {
+                const POS_T x = POS_T(sq / 4), y = POS_T(2 * (sq % 4) + (sq / 4 + 1) % 2);
+                for (int b = 0; b < NNUE_BUCKETS; ++b)
+                    psqt_w[kind * 32 + sq][b] = OUTPUT_SCALE * evaluator.piece_score(kind_type[kind], x, y, bucket_phase(b));
+            }
+        }
+    }
+
+    // Загружает сеть из двоичного файла: "CKN1", размеры (uint32: NNUE_HIDDEN, NNUE_L2, NNUE_BUCKETS),
+    // затем массивы b1, w1, psqt_w, b2, w2, w3, b3 в порядке байтов машины
+    // Бросает runtime_error, если файл нельзя прочитать или размеры сети не совпадают
+    void load(const string &path)
+    {
+        ifstream fin(path, ios::binary);
+        if (!fin.is_open())
+            throw runtime_error("can't open " + path);
+        char magic[4];
+        uint32_t dims[3];
+        if (!fin.read(magic, 4) || memcmp(magic, "CKN1", 4) != 0 || !fin.read(reinterpret_cast<char *>(dims), sizeof(dims)))
+            throw runtime_error("bad network file " + path);
+        if (dims[0] != NNUE_HIDDEN || dims[1] != NNUE_L2 || dims[2] != NNUE_BUCKETS)
+            throw runtime_error("network " + path + " has other layer sizes");
+        for (auto &part : parts())
+        {
+            if (!fin.read(static_cast<char *>(part.first), streamsize(part.second)))
+                throw runtime_error("bad network file " + path + ": unexpected end");
+        }
+    }
+
+    // Сохраняет сеть в формате load
+    void save(const string &path) const
+    {
+        ofstream fout(path, ios::binary | ios::trunc);
+        if (!fout.is_open())
+            throw runtime_error("can't open " + path);
+        const uint32_t dims[3] = {NNUE_HIDDEN, NNUE_L2, NNUE_BUCKETS};
+        fout.write("CKN1", 4);
+        fout.write(reinterpret_cast<const char *>(dims), sizeof(dims));
+        for (auto &part : parts())
+            fout.write(static_cast<const char *>(part.first), streamsize(part.second));
+    }
+
+    // Накопитель для позиции, посчитанный с нуля
+    template <class Matrix> void refresh(const Matrix &mtx, nnue_acc &acc) const
+    {
+        for (int side = 0; side < 2; ++side)
+        {
+            memcpy(acc.values[side], b1, sizeof(b1));
+            fill(acc.psqt[side], acc.psqt[side] + NNUE_BUCKETS, 0);
+            acc.count[side] = 0;
+        }
+        for (POS_T x = 0; x < 8; ++x)
+        {
+            for (POS_T y = (x + 1) % 2; y < 8; y += 2)
+            {
+                if (mtx[x][y])
+                    update_piece<true>(acc, mtx[x][y], x, y);
+            }
+        }
+    }
+
+    // Обновляет накопитель позиции mtx на ход move (mtx - позиция до хода)
+    template <class Matrix> void update(nnue_acc &acc, const Matrix &mtx, const full_move &move) const
+    {
+        const POS_T type = mtx[move.x][move.y];
+        update_piece<false>(acc, type, move.x, move.y);
+        for (uint8_t i = 0; i < move.size; ++i)
+        {
+            const POS_T xb = POS_T(move.beat_path[i] / 8), yb = POS_T(move.beat_path[i] % 8);
+            update_piece<false>(acc, mtx[xb][yb], xb, yb);
+        }
+        update_piece<true>(acc, POS_T(type + (move.is_promotion ? 2 : 0)), move.x2, move.y2);
+    }
+
+    // Оценка с точки зрения color по накопителю
+    // У обеих сторон должны быть фигуры (окончание партии проверяет вызывающий)
+    int evaluate(const nnue_acc &acc, const bool color) const
+    {
+        const int us = color, them = !color;
+        alignas(32) uint8_t input[2 * NNUE_HIDDEN];
+        activate(acc.values[us], input);
+        activate(acc.values[them], input + NNUE_HIDDEN);
+        int32_t out = b3;
+        for (int j = 0; j < NNUE_L2; ++j)
+        {
+            const int32_t value = (b2[j] + dot(input, w2[j])) >> L2_SHIFT;
+            out += int32_t(w3[j]) * min(max(value, 0), ACT_MAX);
+        }
+        const int bucket = bucket_of(acc.count[0] + acc.count[1]);
+        return ((acc.psqt[us][bucket] - acc.psqt[them][bucket]) / 2 + out) / OUTPUT_SCALE;
+    }
+
+  private:
+    static constexpr int ACT_MAX = 127;      // Верхняя граница ограниченного ReLU
+    static constexpr int L2_SHIFT = 6;       // Сдвиг второго слоя: веса int8 хранятся умноженными на 64
+    static constexpr int OUTPUT_SCALE = 16;  // Выход сети и psqt хранятся умноженными на 16
+
+    // Набор линейной части по количеству фигур: 1-6, 7-12, 13-18, 19-24
+    static int bucket_of(const int pieces)
+    {
+        return min(NNUE_BUCKETS - 1, max(0, (pieces - 1) * NNUE_BUCKETS / 24));
+    }
+
+    // Фаза (см. Models/Weights.h) середины набора b - для сети из оценки по весам
+    static int bucket_phase(const int b)
+    {
+        return min(PHASE_MAX, 24 * b / NNUE_BUCKETS + 3);
+    }
+
+    // Номер входа: фигура type на поле x, y с точки зрения стороны side (для черных доска повернута)
+    static int feature(const int side, const POS_T type, const POS_T x, const POS_T y)
+    {
+        const int sq = square_index(x, y);
+        const bool is_own = ((type % 2 == 1) == (side == 0));
+        const int kind = (type > 2 ? 1 : 0) + (is_own ? 0 : 2);
+        return kind * 32 + (side == 0 ? sq : 31 - sq);
+    }
+
+    // Добавляет (is_add) или убирает фигуру из накопителя
+    template <bool is_add> void update_piece(nnue_acc &acc, const POS_T type, const POS_T x, const POS_T y) const
+    {
+        for (int side = 0; side < 2; ++side)
+        {
+            const int f = feature(side, type, x, y);
+            update_row<is_add>(acc.values[side], w1[f]);
+            for (int b = 0; b < NNUE_BUCKETS; ++b)
+                acc.psqt[side][b] += (is_add ? psqt_w[f][b] : -psqt_w[f][b]);
+        }
+        acc.count[type % 2 ? 0 : 1] += (is_add ? 1 : -1);
+    }
+
+    // acc += row или acc -= row для строки первого слоя
+    template <bool is_add> static void update_row(int16_t *acc, const int16_t *row)
+    {
+#if defined(NNUE_AVX2)
+        for (int i = 0; i < NNUE_HIDDEN; i += 16)
+        {
+            const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(acc + i));
+            const __m256i r = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(row + i));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(acc + i), is_add ? _mm256_add_epi16(a, r) : _mm256_sub_epi16(a, r));
+        }
+#elif defined(NNUE_SSE2)
+        for (int i = 0; i < NNUE_HIDDEN; i += 8)
+        {
+            const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(acc + i));
+            const __m128i r = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(acc + i), is_add ? _mm_add_epi16(a, r) : _mm_sub_epi16(a, r));
+        }
+#else
+        for (int i = 0; i < NNUE_HIDDEN; ++i)
+            acc[i] = int16_t(is_add ? acc[i] + row[i] : acc[i] - row[i]);
+#endif
+    }
+
+    // Ограниченный ReLU первого слоя: int16 -> uint8 в [0, ACT_MAX]
+    static void activate(const int16_t *values, uint8_t *out)
+    {
+#if defined(NNUE_AVX2)
+        const __m256i max_value = _mm256_set1_epi8(ACT_MAX);
+        for (int i = 0; i < NNUE_HIDDEN; i += 32)
+        {
+            const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(values + i));
+            const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(values + i + 16));
+            // packus перемежает 128-битные половины a и b, permute восстанавливает порядок
+            const __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xD8);
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), _mm256_min_epu8(packed, max_value));
+        }
+#elif defined(NNUE_SSE2)
+        const __m128i max_value = _mm_set1_epi8(ACT_MAX);
+        for (int i = 0; i < NNUE_HIDDEN; i += 16)
+        {
+            const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(values + i));
+            const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(values + i + 8));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), _mm_min_epu8(_mm_packus_epi16(a, b), max_value));
+        }
+#else
+        for (int i = 0; i < NNUE_HIDDEN; ++i)
+            out[i] = uint8_t(min(max(int(values[i]), 0), ACT_MAX));
+#endif
+    }
+
+    // Скалярное произведение входа второго слоя (uint8) на строку весов (int8)
+    static int32_t dot(const uint8_t *input, const int8_t *row)
+    {
+#if defined(NNUE_AVX2)
+        const __m256i ones = _mm256_set1_epi16(1);
+        __m256i sum = _mm256_setzero_si256();
+        for (int i = 0; i < 2 * NNUE_HIDDEN; i += 32)
+        {
+            const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(input + i));
+            const __m256i w = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(row + i));
+            // Пары произведений не переполняют int16: 2 * 127 * 128 < 32768
+            sum = _mm256_add_epi32(sum, _mm256_madd_epi16(_mm256_maddubs_epi16(x, w), ones));
+        }
+        return horizontal_sum(_mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1)));
+#elif defined(NNUE_SSE2)
+        const __m128i zero = _mm_setzero_si128();
+        __m128i sum = zero;
+        for (int i = 0; i < 2 * NNUE_HIDDEN; i += 16)
+        {
+            const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input + i));
+            const __m128i w = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row + i));
+            // Расширяем до int16: вход - нулями, веса - со знаком (байт в старшей половине и сдвиг вправо)
+            const __m128i x_lo = _mm_unpacklo_epi8(x, zero), x_hi = _mm_unpackhi_epi8(x, zero);
+            const __m128i w_lo = _mm_srai_epi16(_mm_unpacklo_epi8(w, w), 8), w_hi = _mm_srai_epi16(_mm_unpackhi_epi8(w, w), 8);
+            sum = _mm_add_epi32(sum, _mm_add_epi32(_mm_madd_epi16(x_lo, w_lo), _mm_madd_epi16(x_hi, w_hi)));
+        }
+        return horizontal_sum(sum);
+#else
+        int32_t sum = 0;
+        for (int i = 0; i < 2 * NNUE_HIDDEN; ++i)
+            sum += int32_t(input[i]) * row[i];
+        return sum;
+#endif
+    }
+
+#if defined(NNUE_AVX2) || defined(NNUE_SSE2)
+    static int32_t horizontal_sum(__m128i sum)
+    {
+        sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4E));
+        sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xB1));
+        return _mm_cvtsi128_si32(sum);
+    }
+#endif
+
+    // Массивы параметров в порядке записи в файл (для load они же - куда читать)
+    array<pair<void *, size_t>, 7> parts() const
+    {
+        auto self = const_cast<Nnue *>(this);
+        return {{{self->b1, sizeof(b1)}, {self->w1, sizeof(w1)}, {self->psqt_w, sizeof(psqt_w)}, {self->b2, sizeof(b2)},
+                 {self->w2, sizeof(w2)}, {self->w3, sizeof(w3)}, {&self->b3, sizeof(b3)}}};
+    }
+
+  private:
+    alignas(32) int16_t w1[NNUE_INPUTS][NNUE_HIDDEN] = {};     // Веса первого слоя
+    alignas(32) int16_t b1[NNUE_HIDDEN] = {};                  // Смещения первого слоя
+    int32_t psqt_w[NNUE_INPUTS][NNUE_BUCKETS] = {};            // Линейная часть "фигура-поле"
+    alignas(32) int8_t w2[NNUE_L2][2 * NNUE_HIDDEN] = {};      // Веса второго слоя (вход: сначала ходящая сторона)
+    int32_t b2[NNUE_L2] = {};                                  // Смещения второго слоя
+    int8_t w3[NNUE_L2] = {};                                   // Веса выхода
+    int32_t b3 = 0;                                            // Смещение выхода
+};
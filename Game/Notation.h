@@ -0,0 +1,233 @@
+#pragma once
+#include <cctype>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../Models/Move.h"
+#include "Logic.h"
+
+using namespace std;
+
+// Текстовая нотация позиций и ходов для консольных утилит (протокол движка, анализ)
+// Поля обозначаются как в русских шашках: столбцы a-h слева направо, ряды 1-8 снизу вверх,
+// белые начинают снизу. Клетка mtx[x][y] соответствует полю (char('a' + y), 8 - x).
+// Ход записывается через "-" (c3-d4), серия взятий - через ":" со всеми полями остановки (c3:e5:c7).
+// Позиция записывается в формате FEN из PDN: "W:Wa1,c1,Kd4:Bb8,h8",
+// где первая буква - очередь хода, K - дамка.
+
+// Начальная расстановка фигур
+const string start_fen = "W:Wa1,a3,b2,c1,c3,d2,e1,e3,f2,g1,g3,h2:Ba7,b6,b8,c7,d6,d8,e7,f6,f8,g7,h6,h8";
+
+// Название поля по координатам матрицы
+inline string square_name(const POS_T x, const POS_T y)
+{
+    return string{char('a' + y), char('8' - x)};
+}
+
+// Разбирает название поля, например "c3"
+// Бросает runtime_error, если поле некорректно или не является темным
+inline void parse_square(const string &name, POS_T &x, POS_T &y)
+{
+    if (name.size() != 2 || name[0] < 'a' || name[0] > 'h' || name[1] < '1' || name[1] > '8')
+        throw runtime_error("bad square '" + name + "'");
+    x = POS_T('8' - name[1]);
+    y = POS_T(name[0] - 'a');
+    if ((x + y) % 2 == 0)
+        throw runtime_error("square '" + name + "' is not playable");
+}
+
+// Записывает позицию в FEN
+// Параметр color: очередь хода (false = белые, true = черные)
+inline string to_fen(const vector<vector<POS_T>> &mtx, const bool color)
+{
+    string res = color ? "B" : "W";
+    for (POS_T side = 1; side <= 2; ++side)
+    {
+        res += (side == 1 ? ":W" : ":B");
+        bool first = true;
+        // Перебираем поля в порядке a1, a3, ..., h8
+        for (POS_T j = 0; j < 8; ++j)
+        {
+            for (POS_T i = 7; i >= 0; --i)
+            {
+                if (!mtx[i][j] || mtx[i][j] % 2 != side % 2)
+                    continue;
+                if (!first)
+                    res += ",";
+                first = false;
+                if (mtx[i][j] > 2)
+                    res += "K";
+                res += square_name(i, j);
+            }
+        }
+    }
+    return res;
+}
+
+// Разбирает позицию в FEN (регистр букв не важен, пробелы и кавычки игнорируются)
+// Бросает runtime_error при ошибке формата
+inline void parse_fen(const string &fen, vector<vector<POS_T>> &mtx, bool &color)
+{
+    string clean;
+    for (char c : fen)
+    {
+        if (!isspace((unsigned char)c) && c != '"')
+            clean += c;
+    }
+    mtx.assign(8, vector<POS_T>(8, 0));
+    if (clean.empty() || (toupper(clean[0]) != 'W' && toupper(clean[0]) != 'B'))
+        throw runtime_error("bad FEN '" + fen + "': side to move expected");
+    color = (toupper(clean[0]) == 'B');
+    stringstream ss(clean.substr(1));
+    string part;
+    while (getline(ss, part, ':'))
+    {
+        if (part.empty())
+            continue;
+        const char side_name = char(toupper(part[0]));
+        if (side_name != 'W' && side_name != 'B')
+            throw runtime_error("bad FEN '" + fen + "': color expected");
+        const POS_T side = (side_name == 'W' ? 1 : 2);
+        stringstream pieces(part.substr(1));
+        string piece;
+        while (getline(pieces, piece, ','))
+        {
+            if (piece.empty())
+                continue;
+            const bool is_queen = (toupper(piece[0]) == 'K');
+            if (is_queen)
+                piece = piece.substr(1);
+            if (!piece.empty())
+                piece[0] = char(tolower(piece[0]));
+            POS_T x, y;
+            parse_square(piece, x, y);
+            if (mtx[x][y])
+                throw runtime_error("bad FEN '" + fen + "': square " + piece + " is occupied twice");
+            mtx[x][y] = side + (is_queen ? 2 : 0);
+        }
+    }
+}
+
+// Записывает ход (серию взятий целиком) в нотации c3-d4 или c3:e5:c7
+inline string turns_to_string(const vector<move_pos> &turns)
+{
+    if (turns.empty())
+        return "(none)";
+    string res = square_name(turns[0].x, turns[0].y);
+    for (auto turn : turns)
+    {
+        res += (turn.xb != -1 ? ":" : "-");
+        res += square_name(turn.x2, turn.y2);
+    }
+    return res;
+}
+
+// Записывает оценку для протокола движка: "cp N" (N - сотые доли шашки)
+// или "mate N" - выигрыш (проигрыш при отрицательном N) через N ходов
+inline string score_to_string(const int score)
+{
+    if (score >= INF - 1000)
+        return "mate " + to_string((INF - score + 1) / 2);
+    if (score <= -INF + 1000)
+        return "mate -" + to_string((INF + score) / 2);
+    return "cp " + to_string(score);
+}
+
+// Разбивает главный вариант (элементарные ходы подряд) на полуходы
+// Взятие продолжает предыдущий полуход, если начинается с поля, на котором закончилось предыдущее взятие
+inline vector<vector<move_pos>> split_pv(const vector<move_pos> &pv)
+{
+    vector<vector<move_pos>> res;
+    for (size_t i = 0; i < pv.size(); ++i)
+    {
+        const bool is_continuation = (i > 0 && pv[i].xb != -1 && pv[i - 1].xb != -1 && pv[i].x == pv[i - 1].x2 &&
+                                      pv[i].y == pv[i - 1].y2);
+        if (!is_continuation)
+            res.emplace_back();
+        res.back().push_back(pv[i]);
+    }
+    return res;
+}
+
+// Записывает главный вариант: полуходы через пробел
+inline string pv_to_string(const vector<move_pos> &pv)
+{
+    string res;
+    for (auto &turns : split_pv(pv))
+        res += (res.empty() ? "" : " ") + turns_to_string(turns);
+    return res;
+}
+
+// Рекурсивно ищет полную серию взятий, начинающуюся с turns, поля остановки которой
+// проходят через squares[next..] по порядку и заканчиваются последним из них
+// Найденная серия дописывается в res
+inline bool find_series(const vector<vector<POS_T>> &mtx, const vector<pair<POS_T, POS_T>> &squares, const size_t next,
+                        const vector<move_pos> &turns, vector<move_pos> &res)
+{
+    for (auto turn : turns)
+    {
+        if (res.empty() && (turn.x != squares[0].first || turn.y != squares[0].second))
+            continue;
+        const bool is_match = (next < squares.size() && turn.x2 == squares[next].first && turn.y2 == squares[next].second);
+        res.push_back(turn);
+        auto new_mtx = Logic::make_turn(mtx, turn);
+        vector<move_pos> continuations;
+        if (!Logic::find_turns(turn.x2, turn.y2, new_mtx, continuations))
+        {
+            if (is_match && next + 1 == squares.size())
+                return true;
+        }
+        else
+        {
+            // Поле может совпасть случайно, поэтому пробуем и засчитать его, и пропустить
+            if (is_match && find_series(new_mtx, squares, next + 1, continuations, res))
+                return true;
+            if (find_series(new_mtx, squares, next, continuations, res))
+                return true;
+        }
+        res.pop_back();
+    }
+    return false;
+}
+
+// Разбирает ход в нотации c3-d4, c3:e5:c7 или c3xe5 и проверяет его допустимость в позиции mtx
+// Для взятий допускается сокращенная запись (c3:c7), в которой указаны не все поля остановки
+// Возвращает последовательность элементарных ходов, пригодную для make_turn
+// Бросает runtime_error, если ход некорректен или недопустим
+inline vector<move_pos> parse_turns(const vector<vector<POS_T>> &mtx, const bool color, const string &text)
+{
+    vector<pair<POS_T, POS_T>> squares;
+    string cur;
+    for (size_t i = 0; i <= text.size(); ++i)
+    {
+        if (i == text.size() || text[i] == '-' || text[i] == ':' || text[i] == 'x')
+        {
+            POS_T x, y;
+            parse_square(cur, x, y);
+            squares.emplace_back(x, y);
+            cur.clear();
+        }
+        else
+            cur += text[i];
+    }
+    if (squares.size() < 2)
+        throw runtime_error("bad move '" + text + "'");
+
+    vector<move_pos> turns;
+    const bool have_beats = Logic::find_turns(color, mtx, turns);
+    vector<move_pos> res;
+    if (!have_beats)
+    {
+        for (auto turn : turns)
+        {
+            if (squares.size() == 2 && turn == move_pos{squares[0].first, squares[0].second, squares[1].first, squares[1].second})
+                return {turn};
+        }
+        throw runtime_error("illegal move '" + text + "'");
+    }
+    if (!find_series(mtx, squares, 1, turns, res))
+        throw runtime_error("illegal move '" + text + "'");
+    return res;
+}
@@ -0,0 +1,351 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+    #include <fstream>
+    #include <sstream>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+#include "../Models/Move.h"
+#include "Logic.h"
+#include "Notation.h"
+
+using namespace std;
+
+// Партия, прочитанная из PDN (Portable Draughts Notation)
+// Все строки ссылаются на память входного текста и действительны, пока жив PdnReader
+struct pdn_game
+{
+    vector<pair<string_view, string_view>> tags;  // Теги [Name "Value"] в порядке записи
+    vector<string_view> moves;                    // Ходы без номеров, комментариев и вариантов
+    string_view result;                           // Результат ("2-0", "0-2", "1-1", "*" и т.п.), пусто если не указан
+
+    // Возвращает значение тега или пустую строку
+    string_view tag(const string_view name) const
+    {
+        for (auto &t : tags)
+        {
+            if (t.first == name)
+                return t.second;
+        }
+        return {};
+    }
+};
+
+// Потоковый разборщик PDN без копирования: файл отображается в память (mmap),
+// партии выдаются по одной, лексемы - string_view на отображенную память
+// Подходит для коллекций в несколько гигабайт: память под партию переиспользуется между вызовами next
+class PdnReader
+{
+  public:
+    // Разбор текста, уже находящегося в памяти (текст должен жить дольше читателя)
+    PdnReader(const char *data, const size_t size) : text(data, size)
+    {
+    }
+
+    // Разбор файла; бросает runtime_error, если файл нельзя открыть
+    explicit PdnReader(const string &path)
+    {
+#ifdef _WIN32
+        ifstream fin(path, ios::binary);
+        if (!fin.is_open())
+            throw runtime_error("can't open " + path);
+        stringstream ss;
+        ss << fin.rdbuf();
+        buffer = ss.str();
+        text = buffer;
+#else
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            throw runtime_error("can't open " + path);
+        struct stat st;
+        if (fstat(fd, &st) != 0)
+        {
+            close(fd);
+            throw runtime_error("can't stat " + path);
+        }
+        map_size = size_t(st.st_size);
+        if (map_size)
+        {
+            map = mmap(nullptr, map_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (map == MAP_FAILED)
+            {
+                map = nullptr;
+                close(fd);
+                throw runtime_error("can't mmap " + path);
+            }
+            // Файл читается один раз от начала до конца
+            madvise(map, map_size, MADV_SEQUENTIAL);
+            text = string_view(static_cast<const char *>(map), map_size);
+        }
+        close(fd);
+#endif
+    }
+
+    PdnReader(const PdnReader &) = delete;
+    PdnReader &operator=(const PdnReader &) = delete;
+
+    ~PdnReader()
+    {
+#ifndef _WIN32
+        if (map)
+            munmap(map, map_size);
+#endif
+    }
+
+    // Читает следующую партию в game, возвращает false, если партий больше нет
+    bool next(pdn_game &game)
+    {
+        game.tags.clear();
+        game.moves.clear();
+        game.result = {};
+        bool is_any = false;
+        const size_t n = text.size();
+        while (pos < n)
+        {
+            const char c = text[pos];
+            if (char_class(c) == SPACE)
+            {
+                ++pos;
+                continue;
+            }
+            if (c == '[')
+            {
+                // Теги следующей партии, если у текущей не было результата
+                if (!game.moves.empty())
+                    return true;
+                read_tag(game);
+                is_any = true;
+                continue;
+            }
+            if (c == '{')
+            {
+                skip_until('}');
+                continue;
+            }
+            if (c == '(')
+            {
+                skip_variation();
+                continue;
+            }
+            if (c == ';' || (c == '%' && (pos == 0 || text[pos - 1] == '\n')))
+            {
+                skip_until('\n');
+                continue;
+            }
+            string_view token = read_token();
+            is_any = true;
+            if (is_result(token))
+            {
+                game.result = token;
+                return true;
+            }
+            // Номер хода ("12." или "12...") может быть записан слитно с ходом ("12.c3-d4")
+            size_t digits = 0;
+            while (digits < token.size() && token[digits] >= '0' && token[digits] <= '9')
+                ++digits;
+            if (digits < token.size() && token[digits] == '.')
+            {
+                while (digits < token.size() && token[digits] == '.')
+                    ++digits;
+                token.remove_prefix(digits);
+            }
+            // Числовые аннотации ($1) и оценки хода (!, ?) пропускаем
+            while (!token.empty() && (token.back() == '!' || token.back() == '?'))
+                token.remove_suffix(1);
+            if (token.empty() || token[0] == '$')
+                continue;
+            game.moves.push_back(token);
+        }
+        return is_any;
+    }
+
+    // Сколько байт текста уже прочитано
+    size_t position() const
+    {
+        return pos;
+    }
+
+    size_t size() const
+    {
+        return text.size();
+    }
+
+  private:
+    // Классы символов для лексического разбора
+    enum : uint8_t
+    {
+        TOKEN = 0,  // Часть лексемы
+        SPACE = 1,  // Пробельный символ
+        BREAK = 2   // Начало комментария, тега или варианта
+    };
+
+    // Класс символа по таблице (быстрее цепочки сравнений на каждом байте)
+    static uint8_t char_class(const char c)
+    {
+        static const auto table = [] {
+            array<uint8_t, 256> t{};
+            for (unsigned char ch : {' ', '\n', '\r', '\t'})
+                t[ch] = SPACE;
+            for (unsigned char ch : {'{', '(', '[', ';'})
+                t[ch] = BREAK;
+            return t;
+        }();
+        return table[(unsigned char)c];
+    }
+
+    // Проверяет, является ли лексема результатом партии
+    static bool is_result(const string_view token)
+    {
+        // Быстрый отказ для ходов в буквенной нотации
+        if (token.empty() || token.size() > 7 || (token[0] != '0' && token[0] != '1' && token[0] != '2' && token[0] != '*'))
+            return false;
+        return token == "2-0" || token == "0-2" || token == "1-1" || token == "0-0" || token == "1-0" || token == "0-1" ||
+               token == "1/2-1/2" || token == "*";
+    }
+
+    // Лексема до пробела или начала комментария, тега или варианта
+    string_view read_token()
+    {
+        const size_t begin = pos;
+        const size_t n = text.size();
+        while (pos < n && char_class(text[pos]) == TOKEN)
+            ++pos;
+        return text.substr(begin, pos - begin);
+    }
+
+    // Тег вида [Name "Value"]
+    void read_tag(pdn_game &game)
+    {
+        const size_t n = text.size();
+        ++pos;
+        while (pos < n && text[pos] == ' ')
+            ++pos;
+        const size_t name_begin = pos;
+        while (pos < n && text[pos] != ' ' && text[pos] != '"' && text[pos] != ']')
+            ++pos;
+        string_view name = text.substr(name_begin, pos - name_begin);
+        string_view value;
+        while (pos < n && text[pos] != '"' && text[pos] != ']')
+            ++pos;
+        if (pos < n && text[pos] == '"')
+        {
+            const size_t value_begin = ++pos;
+            while (pos < n && text[pos] != '"')
+                pos += (text[pos] == '\\' ? 2 : 1);
+            pos = min(pos, n);
+            value = text.substr(value_begin, pos - value_begin);
+        }
+        skip_until(']');
+        game.tags.emplace_back(name, value);
+    }
+
+    // Пропускает текст до символа end включительно
+    void skip_until(const char end)
+    {
+        const void *found = memchr(text.data() + pos, end, text.size() - pos);
+        pos = found ? size_t(static_cast<const char *>(found) - text.data()) + 1 : text.size();
+    }
+
+    // Пропускает вариант в скобках (варианты могут быть вложенными)
+    void skip_variation()
+    {
+        int level = 0;
+        const size_t n = text.size();
+        for (; pos < n; ++pos)
+        {
+            if (text[pos] == '{')
+            {
+                skip_until('}');
+                --pos;
+            }
+            else if (text[pos] == '(')
+                ++level;
+            else if (text[pos] == ')' && --level == 0)
+            {
+                ++pos;
+                return;
+            }
+        }
+    }
+
+  private:
+    string_view text;
+    size_t pos = 0;
+    void *map = nullptr;
+    size_t map_size = 0;
+#ifdef _WIN32
+    string buffer;
+#endif
+};
+
+// Восстанавливает ходы партии, проверяя их допустимость
+// Начальная позиция берется из тега FEN (если он есть), иначе - стандартная расстановка
+// В mtx и color возвращается начальная позиция; бросает runtime_error при недопустимом ходе
+inline vector<vector<move_pos>> pdn_to_turns(const pdn_game &game, vector<vector<POS_T>> &mtx, bool &color)
+{
+    auto fen = game.tag("FEN");
+    parse_fen(fen.empty() ? start_fen : string(fen), mtx, color);
+    vector<vector<move_pos>> res;
+    auto cur_mtx = mtx;
+    bool cur_color = color;
+    for (auto move : game.moves)
+    {
+        res.push_back(parse_turns(cur_mtx, cur_color, string(move)));
+        for (auto turn : res.back())
+            cur_mtx = Logic::make_turn(cur_mtx, turn);
+        cur_color = !cur_color;
+    }
+    return res;
+}
+
+// Записывает партию в PDN
+// Параметр tags: теги партии (Result дописывается автоматически)
+// Параметр turns: ходы партии, каждый - серия элементарных ходов
+// Параметр color: кто ходит первым (false = белые)
+// Параметр result: результат ("2-0" - победа белых, "0-2" - черных, "1-1" - ничья, "*" - не окончена)
+inline void write_pdn(ostream &out, const vector<pair<string, string>> &tags, const vector<vector<move_pos>> &turns,
+                      const bool color, const string &result)
+{
+    for (auto &t : tags)
+        out << "[" << t.first << " \"" << t.second << "\"]\n";
+    out << "[Result \"" << result << "\"]\n";
+    string line;
+    for (size_t i = 0; i < turns.size(); ++i)
+    {
+        string token;
+        const bool is_black = ((i % 2 == 1) != color);
+        if (!is_black)
+            token = to_string((i + color) / 2 + 1) + ". ";
+        else if (i == 0)
+            token = "1... ";
+        token += turns_to_string(turns[i]);
+        // Строки movetext не длиннее 80 символов
+        if (!line.empty() && line.size() + 1 + token.size() > 80)
+        {
+            out << line << "\n";
+            line.clear();
+        }
+        line += (line.empty() ? "" : " ") + token;
+    }
+    if (!line.empty() && line.size() + 1 + result.size() > 80)
+    {
+        out << line << "\n";
+        line.clear();
+    }
+    line += (line.empty() ? "" : " ") + result;
+    out << line << "\n\n";
+}
@@ -0,0 +1,166 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+#include "../Models/Search.h"
+#include "Config.h"
+#include "Logic.h"
+
+using namespace std;
+
+// Запрос на поиск хода для одной из партий сервера (Game/Server.h)
+struct search_request
+{
+    uint64_t game = 0;                              // Номер партии
+    uint64_t seq = 0;                               // Порядковый номер запроса (при равных сроках - раньше пришедший)
+    vector<vector<POS_T>> mtx;                      // Позиция
+    bool color = false;                             // Ходящая сторона
+    search_limits limits;                           // Уровень и бюджет позиций партии
+    chrono::steady_clock::time_point received;      // Когда пришел запрос
+    chrono::steady_clock::time_point deadline;      // Когда ход должен быть готов
+};
+
+// Результат поиска
+struct search_result
+{
+    uint64_t game = 0;
+    uint64_t seq = 0;
+    vector<move_pos> turns;      // Ход (пустой, если ходов нет)
+    int score = 0;               // Оценка с точки зрения ходящей стороны
+    int depth = 0;               // Последний завершенный уровень
+    uint64_t nodes = 0;
+    double wait_ms = 0;          // Ожидание в очереди
+    double latency_ms = 0;       // От прихода запроса до готового хода
+    bool missed = false;         // Ход готов позже срока
+};
+
+// Общий пул потоков поиска для многих партий. Очередь упорядочена по сроку хода (раньше срок - раньше поиск),
+// поэтому партия с коротким контролем не ждет за длинными поисками других партий. Поиск получает время
+// до срока своей партии, а если срок уже прошел - только уровень 0 (ход находится всегда)
+// У каждого потока свой Logic (память поиска - около 1,6 Мб, на каждую партию ее не хватит); Logic::search
+// не переносит состояние между вызовами, кроме кэша оценок, зависящего только от позиции, поэтому партии
+// не влияют друг на друга
+class SearchPool
+{
+  public:
+    // Параметр threads: количество потоков (0 - по числу ядер); on_done вызывается из потока поиска
+    // после каждого готового результата (например, чтобы разбудить цикл сервера)
+    SearchPool(Config *config, const unsigned threads, const function<void()> &on_done) : on_done(on_done)
+    {
+        threads_count = threads ? threads : max(1u, thread::hardware_concurrency());
+        for (unsigned i = 0; i < threads_count; ++i)
+            workers.emplace_back(&SearchPool::worker, this, config);
+    }
+
+    SearchPool(const SearchPool &) = delete;
+    SearchPool &operator=(const SearchPool &) = delete;
+
+    ~SearchPool()
+    {
+        {
+            lock_guard<mutex> lock(mtx);
+            stopping = true;
+        }
+        has_work.notify_all();
+        for (auto &th : workers)
+            th.join();
+    }
+
+    void submit(search_request request)
+    {
+        {
+            lock_guard<mutex> lock(mtx);
+            queue.push(move(request));
+        }
+        has_work.notify_one();
+    }
+
+    // Забирает готовый результат; возвращает false, если готовых нет
+    bool take(search_result &result)
+    {
+        lock_guard<mutex> lock(mtx);
+        if (done.empty())
+            return false;
+        result = move(done.front());
+        done.pop_front();
+        return true;
+    }
+
+    // Запросов в очереди (еще не начатых)
+    size_t queued()
+    {
+        lock_guard<mutex> lock(mtx);
+        return queue.size();
+    }
+
+    unsigned threads_count;
+
+  private:
+    // Меньший срок - выше приоритет
+    struct later_deadline
+    {
+        bool operator()(const search_request &a, const search_request &b) const
+        {
+            return a.deadline != b.deadline ? a.deadline > b.deadline : a.seq > b.seq;
+        }
+    };
+
+    void worker(Config *config)
+    {
+        Logic logic(config);
+        logic.stop_flag = &stopping;
+        while (true)
+        {
+            search_request request;
+            {
+                unique_lock<mutex> lock(mtx);
+                has_work.wait(lock, [this] { return stopping || !queue.empty(); });
+                if (stopping)
+                    return;
+                request = queue.top();
+                queue.pop();
+            }
+            const auto start = chrono::steady_clock::now();
+            search_limits limits = request.limits;
+            limits.infinite = false;
+            const auto left = chrono::duration_cast<chrono::milliseconds>(request.deadline - start).count();
+            if (left <= 0)
+                limits.depth = 0;
+            else
+                limits.movetime_ms = int(min<int64_t>(left, limits.movetime_ms >= 0 ? limits.movetime_ms : left));
+
+            search_result result;
+            result.game = request.game;
+            result.seq = request.seq;
+            result.turns = logic.search(request.mtx, request.color, limits,
+                                        [&result](const search_info &info) { result.depth = info.depth; });
+            result.score = logic.last_score;
+            result.nodes = logic.nodes;
+            const auto finish = chrono::steady_clock::now();
+            result.wait_ms = chrono::duration<double, milli>(start - request.received).count();
+            result.latency_ms = chrono::duration<double, milli>(finish - request.received).count();
+            result.missed = (finish > request.deadline);
+            {
+                lock_guard<mutex> lock(mtx);
+                done.push_back(move(result));
+            }
+            if (on_done)
+                on_done();
+        }
+    }
+
+    function<void()> on_done;
+    vector<thread> workers;
+    mutex mtx;
+    condition_variable has_work;
+    atomic<bool> stopping{false};
+    priority_queue<search_request, vector<search_request>, later_deadline> queue;
+    deque<search_result> done;
+};
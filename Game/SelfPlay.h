@@ -0,0 +1,131 @@
+#pragma once
+#include <atomic>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "../Models/Packed.h"
+#include "../Models/Search.h"
+#include "Config.h"
+#include "Logic.h"
+#include "Notation.h"
+#include "TrainingData.h"
+
+using namespace std;
+
+// Генератор обучающих данных: партии бота с самим собой в нескольких потоках
+// Каждая партия начинается с random_plies случайных полуходов (разнообразие дебютов), дальше оба цвета
+// ищут ход с ограничениями limits; каждая позиция после дебюта записывается с оценкой поиска, выбранным ходом
+// и результатом партии (ничья - после max_plies полуходов). У каждого потока свой Logic,
+// общий только счетчик партий и запись в файл (готовые партии целиком под мьютексом)
+class SelfPlay
+{
+  public:
+    // Параметр threads: количество потоков (0 - по числу ядер); seed - зерно случайных дебютов
+    SelfPlay(Config *config, const search_limits &limits, const int random_plies, const int max_plies, const unsigned threads,
+             const unsigned seed = 0)
+        : config(config), limits(limits), random_plies(random_plies), max_plies(max_plies), seed(seed)
+    {
+        threads_count = threads ? threads : max(1u, thread::hardware_concurrency());
+    }
+
+    // Играет games партий и записывает их позиции в writer; возвращает количество позиций (до отбрасывания повторов)
+    uint64_t run(const size_t games, TrainingWriter &writer)
+    {
+        next_game = 0;
+        positions = 0;
+        vector<thread> workers;
+        for (unsigned i = 0; i < threads_count; ++i)
+            workers.emplace_back(&SelfPlay::worker, this, games, ref(writer));
+        for (auto &th : workers)
+            th.join();
+        return positions;
+    }
+
+    // Переводит ход-серию в поля записи (откуда, куда, побитые)
+    static void set_move(training_record &record, const vector<move_pos> &turns)
+    {
+        record.from = uint8_t(square_index(turns.front().x, turns.front().y));
+        record.to = uint8_t(square_index(turns.back().x2, turns.back().y2));
+        record.beats = 0;
+        for (auto &turn : turns)
+        {
+            if (turn.xb != -1)
+                record.beats |= uint32_t(1) << square_index(turn.xb, turn.yb);
+        }
+    }
+
+    // Партия номер index: записи позиций в game с результатом для белых
+    // Дебют и перемешивание ходов бота зависят только от seed и index, поэтому партии разных потоков различаются,
+    // а партию можно переиграть в другом процессе (Game/Worker.h)
+    void play(Logic &logic, const size_t index, vector<training_record> &game)
+    {
+        game.clear();
+        vector<vector<POS_T>> mtx;
+        bool color;
+        parse_fen(start_fen, mtx, color);
+        mt19937 rng(seed + unsigned(index));
+        logic.seed(seed ^ (unsigned(index) * 2654435761u));
+        move_list moves;
+        vector<move_pos> turns;
+        int result = 1;
+        for (int ply = 0; ply < max_plies; ++ply)
+        {
+            Logic::find_moves(color, mtx, moves);
+            if (moves.empty())
+            {
+                result = (color ? 2 : 0);
+                break;
+            }
+            if (ply < random_plies)
+            {
+                turns.clear();
+                moves[rng() % moves.size()].to_turns(turns);
+            }
+            else
+            {
+                turns = logic.search(mtx, color, limits);
+                training_record record;
+                record.pos = pack_position(mtx, color, 1);
+                record.pos.ply = uint16_t(ply);
+                record.score = int16_t(max(-32000, min(32000, logic.last_score)));
+                set_move(record, turns);
+                game.push_back(record);
+            }
+            for (auto &turn : turns)
+                mtx = Logic::make_turn(mtx, turn);
+            color = !color;
+        }
+        for (auto &record : game)
+            record.pos.result = uint8_t(result);
+    }
+
+  private:
+    void worker(const size_t games, TrainingWriter &writer)
+    {
+        Logic logic(config);
+        vector<training_record> game;
+        while (true)
+        {
+            const size_t index = next_game.fetch_add(1);
+            if (index >= games)
+                break;
+            play(logic, index, game);
+            lock_guard<mutex> lock(writer_mtx);
+            for (auto &record : game)
+                writer.add(record);
+            positions += game.size();
+        }
+    }
+
+    Config *config;
+    search_limits limits;
+    int random_plies;
+    int max_plies;
+    unsigned seed;
+    unsigned threads_count;
+    atomic<size_t> next_game{0};
+    uint64_t positions = 0;  // Защищено writer_mtx
+    mutex writer_mtx;
+};
@@ -0,0 +1,332 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <vector>
+
+#ifndef _WIN32
+    #include <fcntl.h>
+    #include <poll.h>
+    #include <unistd.h>
+#endif
+
+#include "Config.h"
+#include "Logic.h"
+#include "Net.h"
+#include "Notation.h"
+#include "SearchPool.h"
+
+using namespace std;
+
+// Сервер без графики: много партий одновременно через сокет (Game/Net.h, строки JSON), ходы ботов ищет
+// общий пул потоков (Game/SearchPool.h) в порядке сроков ходов партий
+// Команды клиента (ответы приходят тому же клиенту):
+//   {"type": "new", "fen": F, "bot": "white"|"black"|"both"|"none", "level": L, "nodes": N, "movetime": MS,
+//    "max_plies": P}                                    -> {"type": "created", "game": G, "fen": F}
+//       Все поля, кроме type, необязательны: начальная позиция, бот за черных, уровень 5, 1000 мс на ход, 200 полуходов
+//   {"type": "move", "game": G, "move": "c3-d4"}      - ход человека (нотация Notation.h) -> {"type": "moved", ...}
+//   {"type": "go", "game": G}                         - найти ход за ходящую сторону, даже если она не бот
+//   {"type": "close", "game": G}                      - закончить партию
+//   {"type": "stats"}                                 -> {"type": "stats", "games": .., "p50_ms": .., "p99_ms": .., ...}
+// Ход бота: {"type": "bestmove", "game": G, "move": M, "score": S, "depth": D, "nodes": N, "latency_ms": T}
+// Конец партии: {"type": "over", "game": G, "result": "1-0"|"0-1"|"1/2-1/2"}; ошибки: {"type": "error", "message": ...}
+// Партии клиента закрываются при его отключении. Сокеты клиентов неблокирующие: ответы копятся в буфере клиента
+// и досылаются по готовности сокета (POLLOUT), так что медленный клиент не задерживает остальных; клиент,
+// у которого накопилось больше max_output неотправленных байт, отключается
+class Server
+{
+  public:
+    // Параметр threads: потоки поиска (0 - по числу ядер)
+    Server(Config *config, const string &address, const unsigned threads)
+        : listener(LineSocket::listen_on(address))
+    {
+#ifndef _WIN32
+        if (pipe(wake_pipe) != 0)
+            throw runtime_error("can't create pipe");
+        fcntl(wake_pipe[0], F_SETFL, O_NONBLOCK);
+        fcntl(wake_pipe[1], F_SETFL, O_NONBLOCK);
+#endif
+        pool = make_unique<SearchPool>(config, threads, [this] { wake(); });
+    }
+
+    ~Server()
+    {
+        pool.reset();  // Потоки пула пишут в канал, поэтому останавливаются раньше его закрытия
+#ifndef _WIN32
+        close(wake_pipe[0]);
+        close(wake_pipe[1]);
+#endif
+    }
+
+    // Обслуживает клиентов, пока не установлен stop_flag (проверяется раз в 100 мс)
+    void run(const atomic<bool> *stop_flag = nullptr)
+    {
+#ifndef _WIN32
+        while (!stop_flag || !stop_flag->load())
+        {
+            vector<pollfd> fds = {{listener.fd, POLLIN, 0}, {wake_pipe[0], POLLIN, 0}};
+            vector<uint64_t> ids;
+            for (auto &[id, sock] : clients)
+            {
+                fds.push_back({sock.fd, short(POLLIN | (sock.pending() ? POLLOUT : 0)), 0});
+                ids.push_back(id);
+            }
+            if (poll(fds.data(), fds.size(), 100) <= 0)
+                continue;
+            if (fds[1].revents)
+            {
+                char buffer[256];
+                while (read(wake_pipe[0], buffer, sizeof(buffer)) > 0)
+                {
+                }
+            }
+            search_result result;
+            while (pool->take(result))
+                finish_search(result);
+            for (size_t i = 0; i < ids.size(); ++i)
+            {
+                if ((fds[i + 2].revents & ~POLLOUT) && !serve(ids[i]))
+                    drop(ids[i]);
+            }
+            // Досылка ответов (в том числе накопленных за эту итерацию) и отключение переполненных клиентов
+            for (auto &id : ids)
+            {
+                auto it = clients.find(id);
+                if (it != clients.end() && (!it->second.flush() || it->second.pending() > max_output))
+                    drop(id);
+            }
+            if (fds[0].revents & POLLIN)
+            {
+                LineSocket sock = listener.accept_client();
+                if (sock.fd >= 0)
+                {
+                    sock.set_nonblocking();
+                    clients.emplace(next_client++, move(sock));
+                }
+            }
+        }
+#endif
+    }
+
+    // Статистика задержек: доля p (0..1) времени хода бота от прихода запроса до ответа, в миллисекундах,
+    // по последним latency_window ходам
+    double latency_percentile(const double p) const
+    {
+        if (latencies.empty())
+            return 0;
+        vector<float> sorted = latencies;
+        const size_t k = min(sorted.size() - 1, size_t(p * double(sorted.size())));
+        nth_element(sorted.begin(), sorted.begin() + long(k), sorted.end());
+        return sorted[k];
+    }
+
+    json stats() const
+    {
+        return {{"type", "stats"},
+                {"games", games.size()},
+                {"threads", pool->threads_count},
+                {"moves", moves},
+                {"p50_ms", latency_percentile(0.5)},
+                {"p99_ms", latency_percentile(0.99)},
+                {"max_ms", max_latency},
+                {"missed_deadlines", missed},
+                {"games_finished", finished}};
+    }
+
+  private:
+    struct server_game
+    {
+        uint64_t client = 0;
+        vector<vector<POS_T>> mtx;
+        bool color = false;
+        bool bot[2] = {false, true};  // Бот за белых и за черных
+        search_limits limits;
+        int movetime_ms = 1000;
+        int max_plies = 200;
+        int ply = 0;
+        bool busy = false;            // Ждет хода из пула
+        chrono::steady_clock::time_point requested;  // Для ответа на ход человека: отсчет задержки бота
+    };
+
+    void wake()
+    {
+#ifndef _WIN32
+        const char byte = 0;
+        [[maybe_unused]] const ssize_t res = write(wake_pipe[1], &byte, 1);  // Канал полон - цикл и так проснется
+#endif
+    }
+
+    // Принимает данные клиента и выполняет его команды; возвращает false при отключении
+    bool serve(const uint64_t client)
+    {
+        LineSocket &sock = clients.at(client);
+        if (!sock.receive())
+            return false;
+        string line;
+        while (sock.pending() <= max_output && sock.next_line(line))
+        {
+            json answer;
+            try
+            {
+                answer = handle(client, json::parse(line));
+            }
+            catch (const exception &e)
+            {
+                answer = {{"type", "error"}, {"message", e.what()}};
+            }
+            if (!answer.is_null() && !sock.queue_line(answer.dump()))
+                return false;
+        }
+        return true;
+    }
+
+    json handle(const uint64_t client, const json &msg)
+    {
+        const string type = msg.value("type", "");
+        if (type == "stats")
+            return stats();
+        if (type == "new")
+        {
+            server_game game;
+            game.client = client;
+            parse_fen(msg.value("fen", start_fen), game.mtx, game.color);
+            const string bot = msg.value("bot", "black");
+            game.bot[0] = (bot == "white" || bot == "both");
+            game.bot[1] = (bot == "black" || bot == "both");
+            game.limits.depth = msg.value("level", msg.contains("nodes") ? -1 : 5);
+            game.limits.nodes = msg.value("nodes", int64_t(-1));
+            game.movetime_ms = max(1, msg.value("movetime", 1000));
+            game.max_plies = msg.value("max_plies", 200);
+            const uint64_t id = next_game++;
+            auto &added = games.emplace(id, move(game)).first->second;
+            send(client, {{"type", "created"}, {"game", id}, {"fen", to_fen(added.mtx, added.color)}});
+            next_turn(id, added, false);
+            return json();
+        }
+        if (type != "close" && type != "go" && type != "move")
+            throw runtime_error("unknown command '" + type + "'");
+        const uint64_t id = msg.at("game");
+        auto it = games.find(id);
+        if (it == games.end() || it->second.client != client)
+            throw runtime_error("no game " + to_string(id));
+        server_game &game = it->second;
+        if (type == "close")
+        {
+            games.erase(it);
+            return json();
+        }
+        if (game.busy)
+            throw runtime_error("game " + to_string(id) + " is waiting for a bot move");
+        if (type == "go")
+        {
+            next_turn(id, game, true);
+            return json();
+        }
+        // Ход человека
+        const auto turns = parse_turns(game.mtx, game.color, msg.at("move"));
+        apply(game, turns);
+        send(client, {{"type", "moved"}, {"game", id}, {"fen", to_fen(game.mtx, game.color)}});
+        next_turn(id, game, false);
+        return json();
+    }
+
+    // Проверяет конец партии; если ходит бот (или force), ставит поиск в очередь пула
+    void next_turn(const uint64_t id, server_game &game, const bool force)
+    {
+        move_list moves;
+        Logic::find_moves(game.color, game.mtx, moves);
+        if (moves.empty() || game.ply >= game.max_plies)
+        {
+            send(game.client, {{"type", "over"},
+                               {"game", id},
+                               {"result", moves.empty() ? (game.color ? "1-0" : "0-1") : "1/2-1/2"}});
+            ++finished;
+            games.erase(id);
+            return;
+        }
+        if (!force && !game.bot[game.color])
+            return;
+        search_request request;
+        request.game = id;
+        request.seq = next_seq++;
+        request.mtx = game.mtx;
+        request.color = game.color;
+        request.limits = game.limits;
+        request.received = chrono::steady_clock::now();
+        request.deadline = request.received + chrono::milliseconds(game.movetime_ms);
+        game.busy = true;
+        pool->submit(move(request));
+    }
+
+    void finish_search(const search_result &result)
+    {
+        if (latencies.size() < latency_window)
+            latencies.push_back(float(result.latency_ms));
+        else
+            latencies[moves % latency_window] = float(result.latency_ms);
+        ++moves;
+        max_latency = max(max_latency, float(result.latency_ms));
+        missed += result.missed;
+        auto it = games.find(result.game);
+        if (it == games.end())
+            return;  // Партия закрыта, пока шел поиск
+        server_game &game = it->second;
+        game.busy = false;
+        vector<move_pos> turns = result.turns;
+        if (turns.empty())
+        {
+            // Поиск прерван до первого хода: любой допустимый ход лучше, чем никакого
+            move_list moves;
+            Logic::find_moves(game.color, game.mtx, moves);
+            moves[0].to_turns(turns);
+        }
+        send(game.client, {{"type", "bestmove"},
+                           {"game", result.game},
+                           {"move", turns_to_string(turns)},
+                           {"score", result.score},
+                           {"depth", result.depth},
+                           {"nodes", result.nodes},
+                           {"latency_ms", int(result.latency_ms)}});
+        apply(game, turns);
+        next_turn(result.game, game, false);
+    }
+
+    static void apply(server_game &game, const vector<move_pos> &turns)
+    {
+        for (auto &turn : turns)
+            game.mtx = Logic::make_turn(game.mtx, turn);
+        game.color = !game.color;
+        ++game.ply;
+    }
+
+    // Ставит сообщение в очередь отправки клиента (отключение обнаружится при досылке или следующем чтении)
+    void send(const uint64_t client, const json &msg)
+    {
+        auto it = clients.find(client);
+        if (it != clients.end())
+            it->second.queue_line(msg.dump());
+    }
+
+    // Отключает клиента и закрывает его партии (их поиски доработают, результаты будут отброшены)
+    void drop(const uint64_t client)
+    {
+        clients.erase(client);
+        for (auto it = games.begin(); it != games.end();)
+            it = (it->second.client == client ? games.erase(it) : next(it));
+    }
+
+    LineSocket listener;
+    int wake_pipe[2] = {-1, -1};    // Пул потоков будит цикл poll записью в этот канал
+    map<uint64_t, LineSocket> clients;
+    map<uint64_t, server_game> games;
+    uint64_t next_client = 0, next_game = 1, next_seq = 0;
+    static const size_t latency_window = 4096;    // Ходов в окне статистики задержек
+    static const size_t max_output = 16 << 20;    // Предел неотправленных данных клиента, байт
+    vector<float> latencies;        // Задержки последних latency_window ходов ботов (кольцевой буфер), мс
+    uint64_t moves = 0;             // Ходов ботов всего
+    float max_latency = 0;          // Наибольшая задержка за все время, мс
+    uint64_t missed = 0;            // Ходов, готовых позже срока
+    uint64_t finished = 0;          // Законченных партий
+    unique_ptr<SearchPool> pool;
+};
@@ -0,0 +1,315 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "../Models/Move.h"
+#include "../Models/Search.h"
+#include "../Models/Zobrist.h"
+#include "Logic.h"
+
+using namespace std;
+
+// Решатель позиций поиском по числам доказательства в глубину (df-pn)
+// Доказывает выигрыш, а не оценивает его: атакующая сторона выигрывает, если у противника не остается ходов,
+// не позже чем через max_plies полуходов. Сначала доказывается выигрыш ходящей стороны, затем (если он опровергнут)
+// выигрыш противника; если опровергнуты оба, за max_plies полуходов никто выигрыш не форсирует - ничья
+// Серия взятий - один ход (Logic::find_moves), поэтому длинные комбинации стоят одного полухода,
+// а поиск идет туда, где у защиты меньше ответов, без ограничения глубины как в альфа-бета
+// Числа доказательства хранятся в таблице ограниченного размера; оставшиеся полуходы входят в ключ,
+// поэтому граф позиций ацикличен и повторения позиций не мешают доказательству
+class Solver
+{
+  public:
+    // Параметр megabytes: размер таблицы (округляется вниз до степени двойки записей)
+    explicit Solver(const size_t megabytes = 64)
+    {
+        size_t count = 2;
+        while (count * 2 * sizeof(tt_entry) <= megabytes * 1024 * 1024)
+            count *= 2;
+        table = make_unique<tt_entry[]>(count);
+        mask = count - 1;
+        uint64_t seed = 0x2545F4914F6CDD1Dull;
+        for (auto &key : ply_keys)
+        {
+            uint64_t z = (seed += 0x9E3779B97F4A7C15ull);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            key = z ^ (z >> 31);
+        }
+    }
+
+    // Решает позицию mtx с очередью хода color: выигрыш или проигрыш не позже чем за max_plies полуходов
+    // (не больше MAX_SOLVE_PLIES), не больше max_nodes позиций на каждое из двух доказательств
+    solve_info solve(const vector<vector<POS_T>> &mtx, const bool color, const int max_plies, const uint64_t max_nodes)
+    {
+        auto start = chrono::steady_clock::now();
+        BOARD_T board;
+        for (POS_T i = 0; i < 8; ++i)
+            for (POS_T j = 0; j < 8; ++j)
+                board[i][j] = mtx[i][j];
+        const int plies = max(0, min(max_plies, MAX_SOLVE_PLIES));
+        moves.resize(size_t(plies) + 1);
+        hashes.resize(size_t(plies) + 1);
+        nodes = 0;
+
+        solve_info info;
+        const uint64_t hash = zobrist_hash(board, color);
+        // Выигрыш ходящей стороны, затем выигрыш противника
+        for (const bool side : {color, !color})
+        {
+            const uint64_t spent = nodes;
+            node_limit = spent + max_nodes;
+            attacker = side;
+            next_generation();
+            mid(board, color, plies, hash, PN_INF, PN_INF);
+            uint32_t phi, delta;
+            lookup(key_of(hash, plies), phi, delta);
+            // Корень - узел атакующего, если он ходит: цель узла достигнута при phi = 0
+            const bool proven = (side == color ? phi == 0 : delta == 0);
+            const bool disproven = (side == color ? delta == 0 : phi == 0);
+            if (proven)
+            {
+                info.result = (side == color ? SolveResult::WIN : SolveResult::LOSS);
+                node_limit = nodes + max_nodes;
+                info.plies = extract_line(board, color, plies, hash, info.line);
+                break;
+            }
+            if (!disproven)
+                break;
+            if (side != color)
+                info.result = SolveResult::DRAW;
+        }
+        info.nodes = nodes;
+        info.time_ms = int(chrono::duration<double, milli>(chrono::steady_clock::now() - start).count());
+        return info;
+    }
+
+    // Очищает таблицу
+    void clear()
+    {
+        for (size_t i = 0; i <= mask; ++i)
+            table[i] = tt_entry();
+        generation = 0;
+    }
+
+    static constexpr int MAX_SOLVE_PLIES = 255;
+
+  private:
+    // Запись таблицы: числа узла для его ходящей стороны (phi - доказать ее цель, delta - опровергнуть),
+    // количество позиций, потраченных на узел (при замене остаются записи с большей работой),
+    // и номер доказательства: записи прошлых доказательств считаются пустыми, поэтому таблицу не нужно очищать
+    struct tt_entry
+    {
+        uint64_t key = 0;
+        uint32_t phi = 0, delta = 0;
+        uint32_t work = 0;
+        uint32_t generation = 0;
+    };
+
+    // Начинает новое доказательство (цель узлов зависит от атакующей стороны)
+    void next_generation()
+    {
+        if (++generation == 0)
+        {
+            clear();
+            generation = 1;
+        }
+    }
+
+    static constexpr uint32_t PN_INF = 0x3FFFFFFF;
+
+    uint64_t key_of(const uint64_t hash, const int remaining) const
+    {
+        return hash ^ ply_keys[remaining];
+    }
+
+    // Числа узла с ключом key; неизвестный узел - (1, 1)
+    bool lookup(const uint64_t key, uint32_t &phi, uint32_t &delta) const
+    {
+        const size_t bucket = key & mask & ~size_t(1);
+        for (size_t i = bucket; i < bucket + 2; ++i)
+        {
+            if (table[i].key == key && table[i].generation == generation)
+            {
+                phi = table[i].phi;
+                delta = table[i].delta;
+                return true;
+            }
+        }
+        phi = delta = 1;
+        return false;
+    }
+
+    // Корзина из двух записей: та же позиция перезаписывается, иначе вытесняется запись с меньшей работой
+    void store(const uint64_t key, const uint32_t phi, const uint32_t delta, const uint64_t work)
+    {
+        const size_t bucket = key & mask & ~size_t(1);
+        tt_entry *target = &table[bucket];
+        if (is_current(table[bucket + 1], key) ||
+            (!is_current(table[bucket], key) && work_of(table[bucket + 1]) < work_of(table[bucket])))
+            target = &table[bucket + 1];
+        target->key = key;
+        target->generation = generation;
+        target->phi = phi;
+        target->delta = delta;
+        target->work = uint32_t(min(work, uint64_t(UINT32_MAX)));
+    }
+
+    // Узел mtx с очередью хода color и remaining оставшимися полуходами: расширяет поддерево,
+    // пока phi < th_phi и delta < th_delta (или пока не исчерпан бюджет)
+    // У узла атакующего цель - выигрыш атакующего, у узла защиты - отсутствие этого выигрыша;
+    // phi узла - минимум delta детей, delta - сумма phi детей
+    void mid(const BOARD_T &mtx, const bool color, const int remaining, const uint64_t hash, const uint32_t th_phi,
+             const uint32_t th_delta)
+    {
+        ++nodes;
+        const uint64_t key = key_of(hash, remaining);
+        uint32_t phi, delta;
+        lookup(key, phi, delta);
+        if (phi >= th_phi || delta >= th_delta)
+            return;
+        move_list &turns = moves[remaining];
+        Logic::find_moves(color, mtx, turns);
+        // Нет ходов - ходящая сторона проиграла: цель узла не достигнута в обоих случаях
+        if (turns.empty())
+        {
+            store(key, PN_INF, 0, 1);
+            return;
+        }
+        // Полуходы кончились: атакующий не выиграл
+        if (remaining == 0)
+        {
+            if (color == attacker)
+                store(key, PN_INF, 0, 1);
+            else
+                store(key, 0, PN_INF, 1);
+            return;
+        }
+        uint64_t *child_hashes = hashes[remaining].data();
+        for (size_t i = 0; i < turns.size(); ++i)
+            child_hashes[i] = zobrist_update(hash, mtx, turns[i]);
+
+        const uint64_t start_nodes = nodes;
+        while (true)
+        {
+            uint32_t min_delta = PN_INF, second_delta = PN_INF, best_phi = 0;
+            uint64_t sum_phi = 0;
+            size_t best = 0;
+            for (size_t i = 0; i < turns.size(); ++i)
+            {
+                uint32_t child_phi, child_delta;
+                lookup(key_of(child_hashes[i], remaining - 1), child_phi, child_delta);
+                sum_phi += child_phi;
+                if (child_delta < min_delta)
+                {
+                    second_delta = min_delta;
+                    min_delta = child_delta;
+                    best = i;
+                    best_phi = child_phi;
+                }
+                else if (child_delta < second_delta)
+                    second_delta = child_delta;
+            }
+            phi = min_delta;
+            delta = uint32_t(min(sum_phi, uint64_t(PN_INF)));
+            if (phi >= th_phi || delta >= th_delta || nodes >= node_limit)
+            {
+                store(key, phi, delta, nodes - start_nodes + 1);
+                return;
+            }
+            // Пороги ребенка: его delta не выше следующего по величине, его phi - в пределах остатка порога delta узла
+            const uint32_t child_th_phi = uint32_t(min(uint64_t(th_delta) - delta + best_phi, uint64_t(PN_INF)));
+            const uint32_t child_th_delta = min(th_phi, second_delta == PN_INF ? PN_INF : second_delta + 1);
+            mid(Logic::make_move(mtx, turns[best]), !color, remaining - 1, child_hashes[best], child_th_phi, child_th_delta);
+        }
+    }
+
+    // Записывает в line доказанный вариант из позиции mtx: атакующий выбирает выигрыш с наименьшей работой,
+    // защита - ответ, на опровержение которого ушло больше всего работы. Вытесненные из таблицы узлы решаются заново
+    // (не больше max_nodes позиций; если таблица слишком мала и бюджета не хватило, вариант обрывается)
+    // Возвращает длину варианта в полуходах
+    int extract_line(BOARD_T mtx, bool color, int remaining, uint64_t hash, vector<move_pos> &line)
+    {
+        int plies = 0;
+        move_list turns;
+        while (remaining > 0)
+        {
+            Logic::find_moves(color, mtx, turns);
+            if (turns.empty())
+                break;
+            const bool is_attacker = (color == attacker);
+            size_t best = turns.size();
+            uint64_t best_hash = 0;
+            uint32_t best_work = 0;
+            for (size_t i = 0; i < turns.size(); ++i)
+            {
+                const uint64_t child_hash = zobrist_update(hash, mtx, turns[i]);
+                const uint64_t child_key = key_of(child_hash, remaining - 1);
+                uint32_t phi, delta;
+                if (!lookup(child_key, phi, delta) || (phi && delta))
+                {
+                    mid(Logic::make_move(mtx, turns[i]), !color, remaining - 1, child_hash, PN_INF, PN_INF);
+                    lookup(child_key, phi, delta);
+                }
+                // Ребенок атакующего выигрывает при delta = 0 (цель защиты опровергнута), ребенок защиты - при phi = 0
+                if ((is_attacker ? delta : phi) != 0)
+                    continue;
+                const uint32_t work = entry_work(child_key);
+                if (best == turns.size() || (is_attacker ? work < best_work : work > best_work))
+                {
+                    best = i;
+                    best_hash = child_hash;
+                    best_work = work;
+                }
+            }
+            if (best == turns.size())
+                break;
+            turns[best].to_turns(line);
+            mtx = Logic::make_move(mtx, turns[best]);
+            hash = best_hash;
+            color = !color;
+            --remaining;
+            ++plies;
+        }
+        return plies;
+    }
+
+    bool is_current(const tt_entry &entry, const uint64_t key) const
+    {
+        return entry.key == key && entry.generation == generation;
+    }
+
+    // Работа записи; записи прошлых доказательств вытесняются первыми
+    uint32_t work_of(const tt_entry &entry) const
+    {
+        return (entry.generation == generation ? entry.work : 0);
+    }
+
+    uint32_t entry_work(const uint64_t key) const
+    {
+        const size_t bucket = key & mask & ~size_t(1);
+        for (size_t i = bucket; i < bucket + 2; ++i)
+        {
+            if (is_current(table[i], key))
+                return table[i].work;
+        }
+        return 0;
+    }
+
+  public:
+    uint64_t nodes = 0;  // Счетчик просмотренных позиций последнего вызова solve
+
+  private:
+    unique_ptr<tt_entry[]> table;
+    size_t mask = 0;
+    uint64_t ply_keys[MAX_SOLVE_PLIES + 1];  // Ключи числа оставшихся полуходов (входят в ключ таблицы)
+    vector<move_list> moves;                 // Ходы узла с remaining оставшимися полуходами
+    vector<array<uint64_t, MAX_TURNS>> hashes;  // Хеши детей этого узла
+    uint64_t node_limit = 0;
+    bool attacker = false;                   // Сторона, выигрыш которой доказывается
+    uint32_t generation = 0;                 // Номер текущего доказательства
+};
@@ -0,0 +1,226 @@
+#pragma once
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Сжатие блоков zlib, если собрано с CHECKERS_ZLIB (см. CMakeLists.txt); без него блоки пишутся несжатыми
+#ifdef CHECKERS_ZLIB
+    #include <zlib.h>
+#endif
+
+#include "../Models/Packed.h"
+#include "../Models/Zobrist.h"
+
+using namespace std;
+
+// Количество записей в блоке файла обучающего набора
+const uint32_t TRAINING_BLOCK_RECORDS = 4096;
+
+// Запись обучающего набора в файл формата training_record
+// Перед записью позиции могут проходить через фильтр повторов (таблица хешей с потерями: повтор иногда
+// пропускается, но разные позиции не отбрасываются) и буфер перемешивания: запись выходит из буфера
+// в случайный момент, поэтому соседние позиции одной партии оказываются в файле далеко друг от друга
+class TrainingWriter
+{
+  public:
+    // Параметр shuffle_size: записей в буфере перемешивания (0 - без перемешивания)
+    // Параметр dedup_mb: размер таблицы повторов в мегабайтах (0 - повторы не отбрасываются)
+    // Бросает runtime_error, если файл нельзя создать
+    TrainingWriter(const string &path, const size_t shuffle_size, const size_t dedup_mb, const unsigned seed = 0)
+        : fout(path, ios::binary | ios::trunc), shuffle_size(shuffle_size), rng(seed)
+    {
+        if (!fout.is_open())
+            throw runtime_error("can't open " + path);
+        const uint32_t record_size = sizeof(training_record);
+        fout.write("CKT1", 4);
+        fout.write(reinterpret_cast<const char *>(&record_size), sizeof(record_size));
+        if (dedup_mb)
+        {
+            size_t count = 1;
+            while (count * 2 * sizeof(uint64_t) <= dedup_mb * 1024 * 1024)
+                count *= 2;
+            seen.assign(count, 0);
+        }
+        shuffle_buffer.reserve(shuffle_size);
+        block.reserve(TRAINING_BLOCK_RECORDS);
+    }
+
+    TrainingWriter(const TrainingWriter &) = delete;
+    TrainingWriter &operator=(const TrainingWriter &) = delete;
+
+    // Ошибка записи в деструкторе теряется; чтобы узнать о ней, нужно вызвать close
+    ~TrainingWriter()
+    {
+        try
+        {
+            close();
+        }
+        catch (const exception &)
+        {
+        }
+    }
+
+    // Добавляет запись; возвращает false, если позиция уже встречалась
+    bool add(const training_record &record)
+    {
+        if (!seen.empty())
+        {
+            // Индекс - по всему хешу; в таблице хранится хеш с единичным младшим битом (0 - пустая ячейка)
+            const uint64_t hash = zobrist_hash(unpack_position(record.pos), record.pos.color);
+            const uint64_t key = hash | 1;
+            uint64_t &slot = seen[hash & (seen.size() - 1)];
+            if (slot == key)
+            {
+                ++duplicates;
+                return false;
+            }
+            slot = key;
+        }
+        if (shuffle_buffer.size() < shuffle_size)
+        {
+            shuffle_buffer.push_back(record);
+            return true;
+        }
+        if (shuffle_size)
+        {
+            training_record &slot = shuffle_buffer[rng() % shuffle_size];
+            put(slot);
+            slot = record;
+        }
+        else
+            put(record);
+        return true;
+    }
+
+    // Выводит буфер перемешивания и последний блок; бросает runtime_error при ошибке записи
+    // Вызывается и деструктором
+    void close()
+    {
+        if (!fout.is_open())
+            return;
+        shuffle(shuffle_buffer.begin(), shuffle_buffer.end(), rng);
+        for (auto &record : shuffle_buffer)
+            put(record);
+        shuffle_buffer.clear();
+        flush_block();
+        fout.close();
+    }
+
+    uint64_t written = 0;     // Записей в файле
+    uint64_t duplicates = 0;  // Отброшенных повторов
+    uint64_t bytes = 8;       // Размер файла
+
+  private:
+    void put(const training_record &record)
+    {
+        block.push_back(record);
+        if (block.size() == TRAINING_BLOCK_RECORDS)
+            flush_block();
+    }
+
+    void flush_block()
+    {
+        if (block.empty())
+            return;
+        const uint32_t count = uint32_t(block.size());
+        const size_t raw_size = size_t(count) * sizeof(training_record);
+        uint32_t method = 0;
+        const char *data = reinterpret_cast<const char *>(block.data());
+        uint32_t size = uint32_t(raw_size);
+#ifdef CHECKERS_ZLIB
+        uLongf packed_size = compressBound(uLong(raw_size));
+        packed.resize(packed_size);
+        if (compress2(packed.data(), &packed_size, reinterpret_cast<const Bytef *>(data), uLong(raw_size), 6) == Z_OK &&
+            packed_size < raw_size)
+        {
+            method = 1;
+            data = reinterpret_cast<const char *>(packed.data());
+            size = uint32_t(packed_size);
+        }
+#endif
+        const uint32_t header[3] = {count, method, size};
+        fout.write(reinterpret_cast<const char *>(header), sizeof(header));
+        fout.write(data, streamsize(size));
+        if (!fout)
+            throw runtime_error("write error");
+        written += count;
+        bytes += sizeof(header) + size;
+        block.clear();
+    }
+
+    ofstream fout;
+    size_t shuffle_size;
+    mt19937 rng;
+    vector<uint64_t> seen;                 // Хеши записанных позиций (0 - пусто)
+    vector<training_record> shuffle_buffer;
+    vector<training_record> block;
+#ifdef CHECKERS_ZLIB
+    vector<Bytef> packed;
+#endif
+};
+
+// Последовательное чтение файла обучающего набора по блокам
+class TrainingReader
+{
+  public:
+    // Бросает runtime_error, если файл нельзя открыть или это не обучающий набор
+    explicit TrainingReader(const string &path) : fin(path, ios::binary)
+    {
+        if (!fin.is_open())
+            throw runtime_error("can't open " + path);
+        char magic[4] = {};
+        uint32_t record_size = 0;
+        fin.read(magic, 4);
+        fin.read(reinterpret_cast<char *>(&record_size), sizeof(record_size));
+        if (!fin || memcmp(magic, "CKT1", 4) != 0 || record_size != sizeof(training_record))
+            throw runtime_error("bad training file " + path);
+    }
+
+    // Читает следующую запись; возвращает false в конце файла
+    bool next(training_record &record)
+    {
+        if (pos == block.size() && !read_block())
+            return false;
+        record = block[pos++];
+        return true;
+    }
+
+  private:
+    bool read_block()
+    {
+        uint32_t header[3];
+        if (!fin.read(reinterpret_cast<char *>(header), sizeof(header)))
+            return false;
+        const uint32_t count = header[0], method = header[1], size = header[2];
+        // Пустых блоков TrainingWriter не пишет
+        if (count == 0 || count > TRAINING_BLOCK_RECORDS || method > 1)
+            throw runtime_error("bad training block");
+        block.resize(count);
+        pos = 0;
+        if (method == 0)
+        {
+            if (size != count * sizeof(training_record) || !fin.read(reinterpret_cast<char *>(block.data()), size))
+                throw runtime_error("bad training block");
+            return true;
+        }
+#ifdef CHECKERS_ZLIB
+        vector<Bytef> packed(size);
+        uLongf raw_size = uLongf(count) * sizeof(training_record);
+        if (!fin.read(reinterpret_cast<char *>(packed.data()), size) ||
+            uncompress(reinterpret_cast<Bytef *>(block.data()), &raw_size, packed.data(), size) != Z_OK ||
+            raw_size != count * sizeof(training_record))
+            throw runtime_error("bad training block");
+        return true;
+#else
+        throw runtime_error("compressed training block: build with zlib (CHECKERS_ZLIB)");
+#endif
+    }
+
+    ifstream fin;
+    vector<training_record> block;
+    size_t pos = 0;
+};
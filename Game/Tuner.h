@@ -0,0 +1,390 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+#include "../Models/Packed.h"
+#include "../Models/Weights.h"
+#include "Evaluator.h"
+#include "Logic.h"
+#include "Pdn.h"
+
+using namespace std;
+
+// Результат партии из PDN для белых: 2 - победа, 1 - ничья, 0 - поражение, -1 - не окончена
+inline int pdn_result(const string_view result)
+{
+    if (result == "2-0" || result == "1-0")
+        return 2;
+    if (result == "0-2" || result == "0-1")
+        return 0;
+    if (result == "1-1" || result == "1/2-1/2")
+        return 1;
+    return -1;
+}
+
+// Преобразует партии из PDN в набор упакованных позиций и дописывает их в out
+// В набор попадают только спокойные позиции (без обязательного взятия) начиная с полухода skip_plies:
+// оценочная функция не учитывает взятия, и такие позиции только мешают подбору весов
+// Партии без результата и с недопустимыми ходами пропускаются; возвращает количество записанных позиций
+inline size_t pdn_to_dataset(const string &pdn_path, ostream &out, const int skip_plies = 8)
+{
+    PdnReader reader(pdn_path);
+    pdn_game game;
+    size_t count = 0;
+    vector<packed_position> buffer;
+    vector<move_pos> turns;
+    while (reader.next(game))
+    {
+        const int result = pdn_result(game.result);
+        if (result < 0)
+            continue;
+        vector<vector<POS_T>> mtx;
+        bool color;
+        vector<vector<move_pos>> moves;
+        try
+        {
+            moves = pdn_to_turns(game, mtx, color);
+        }
+        catch (const exception &)
+        {
+            continue;
+        }
+        buffer.clear();
+        for (size_t ply = 0; ply <= moves.size(); ++ply)
+        {
+            if (int(ply) >= skip_plies && !Logic::find_turns(color, mtx, turns) && !turns.empty())
+            {
+                buffer.push_back(pack_position(mtx, color, uint8_t(result)));
+                buffer.back().ply = uint16_t(min<size_t>(ply, UINT16_MAX));
+            }
+            if (ply == moves.size())
+                break;
+            for (auto turn : moves[ply])
+                mtx = Logic::make_turn(mtx, turn);
+            color = !color;
+        }
+        out.write(reinterpret_cast<const char *>(buffer.data()), streamsize(buffer.size() * sizeof(packed_position)));
+        count += buffer.size();
+    }
+    return count;
+}
+
+// Записывает заголовок файла набора позиций
+inline void write_dataset_header(ostream &out)
+{
+    const uint32_t record_size = sizeof(packed_position);
+    out.write("CKP1", 4);
+    out.write(reinterpret_cast<const char *>(&record_size), sizeof(record_size));
+}
+
+// Набор упакованных позиций, отображенный в память (mmap): миллионы позиций не копируются в память процесса
+class PositionsFile
+{
+  public:
+    // Бросает runtime_error, если файл нельзя открыть или это не набор позиций
+    explicit PositionsFile(const string &path)
+    {
+#ifdef _WIN32
+        ifstream fin(path, ios::binary);
+        if (!fin.is_open())
+            throw runtime_error("can't open " + path);
+        buffer.assign(istreambuf_iterator<char>(fin), istreambuf_iterator<char>());
+        bytes = buffer.data();
+        map_size = buffer.size();
+#else
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            throw runtime_error("can't open " + path);
+        struct stat st;
+        if (fstat(fd, &st) != 0)
+        {
+            close(fd);
+            throw runtime_error("can't stat " + path);
+        }
+        map_size = size_t(st.st_size);
+        if (map_size)
+        {
+            map = mmap(nullptr, map_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (map == MAP_FAILED)
+            {
+                map = nullptr;
+                close(fd);
+                throw runtime_error("can't mmap " + path);
+            }
+            bytes = static_cast<const char *>(map);
+        }
+        close(fd);
+#endif
+        uint32_t record_size = 0;
+        if (map_size >= 8)
+            memcpy(&record_size, bytes + 4, sizeof(record_size));
+        if (map_size < 8 || memcmp(bytes, "CKP1", 4) != 0 || record_size != sizeof(packed_position))
+            throw runtime_error("bad positions file " + path);
+        count = (map_size - 8) / sizeof(packed_position);
+    }
+
+    PositionsFile(const PositionsFile &) = delete;
+    PositionsFile &operator=(const PositionsFile &) = delete;
+
+    ~PositionsFile()
+    {
+#ifndef _WIN32
+        if (map)
+            munmap(map, map_size);
+#endif
+    }
+
+    const packed_position *data() const
+    {
+        return reinterpret_cast<const packed_position *>(bytes + 8);
+    }
+
+    size_t size() const
+    {
+        return count;
+    }
+
+  private:
+    const char *bytes = nullptr;
+    size_t map_size = 0;
+    size_t count = 0;
+#ifdef _WIN32
+    string buffer;
+#else
+    void *map = nullptr;
+#endif
+};
+
+// Подбор весов оценки (Texel tuning): минимизирует среднеквадратичную ошибку между результатом партии
+// и вероятностью выигрыша sigmoid(scale * оценка) по всем позициям набора
+// Оценка линейна по весам (см. Evaluator::features), поэтому признаки считаются один раз при загрузке,
+// а каждая эпоха - полный проход по массивам признаков в нескольких потоках
+// Вес Man (в обеих фазах) не подбирается: он задает единицу измерения остальных весов
+class Tuner
+{
+  public:
+    // Параметр threads: количество потоков (0 - по числу ядер)
+    Tuner(const packed_position *positions, const size_t count, const unsigned threads)
+    {
+        threads_count = threads ? threads : max(1u, thread::hardware_concurrency());
+        // Длина массивов кратна LANES: дополнительные позиции без признаков с результатом 0.5 не влияют на ошибку
+        size = count;
+        padded = (count + LANES - 1) / LANES * LANES;
+        for (auto &f : feats)
+            f.assign(padded, 0);
+        phase.assign(padded, 0);
+        label.assign(padded, 0.5f);
+        parallel([&](const size_t from, const size_t to) {
+            int f[TERMS_COUNT], ph;
+            for (size_t i = from; i < min(to, count); ++i)
+            {
+                Evaluator::features(unpack_position(positions[i]), positions[i].color, f, ph);
+                for (int t = 0; t < TERMS_COUNT; ++t)
+                    feats[t][i] = int16_t(f[t]);
+                phase[i] = float(ph) / PHASE_MAX;
+                label[i] = positions[i].result * 0.5f;
+            }
+        });
+    }
+
+    // Среднеквадратичная ошибка на весах w
+    double loss(const eval_weights &w) const
+    {
+        float flat[2 * TERMS_COUNT];
+        flatten(w, flat);
+        return run(flat, nullptr);
+    }
+
+    // Подбирает коэффициент scale, при котором ошибка на весах w минимальна (золотое сечение)
+    double fit_scale(const eval_weights &w)
+    {
+        double lo = 1e-4, hi = 0.1;
+        const double ratio = (sqrt(5.0) - 1) / 2;
+        for (int it = 0; it < 60; ++it)
+        {
+            const double m1 = hi - (hi - lo) * ratio, m2 = lo + (hi - lo) * ratio;
+            scale = m1;
+            const double l1 = loss(w);
+            scale = m2;
+            const double l2 = loss(w);
+            if (l1 < l2)
+                hi = m2;
+            else
+                lo = m1;
+        }
+        scale = (lo + hi) / 2;
+        return scale;
+    }
+
+    // Градиентный спуск (Adam) по полному набору: epochs эпох с шагом rate (в сотых долях шашки)
+    // Параметр on_epoch: вызывается после каждой эпохи с ее номером и ошибкой
+    // Возвращает подобранные веса, округленные до целых
+    eval_weights tune(const eval_weights &start, const int epochs, const double rate,
+                      const function<void(int, double)> &on_epoch = nullptr)
+    {
+        const int n = 2 * TERMS_COUNT;
+        float w[2 * TERMS_COUNT];
+        flatten(start, w);
+        double m[2 * TERMS_COUNT] = {}, v[2 * TERMS_COUNT] = {}, grad[2 * TERMS_COUNT];
+        const double beta1 = 0.9, beta2 = 0.999, eps = 1e-8;
+        for (int epoch = 1; epoch <= epochs; ++epoch)
+        {
+            const double cur_loss = run(w, grad);
+            for (int k = 0; k < n; ++k)
+            {
+                if (k % TERMS_COUNT == TERM_MAN)
+                    continue;
+                m[k] = beta1 * m[k] + (1 - beta1) * grad[k];
+                v[k] = beta2 * v[k] + (1 - beta2) * grad[k] * grad[k];
+                const double m_hat = m[k] / (1 - pow(beta1, epoch)), v_hat = v[k] / (1 - pow(beta2, epoch));
+                w[k] -= float(rate * m_hat / (sqrt(v_hat) + eps));
+            }
+            if (on_epoch)
+                on_epoch(epoch, cur_loss);
+        }
+        eval_weights res;
+        for (int t = 0; t < TERMS_COUNT; ++t)
+        {
+            res.mg[t] = int(lround(w[t]));
+            res.eg[t] = int(lround(w[TERMS_COUNT + t]));
+        }
+        return res;
+    }
+
+    double get_scale() const
+    {
+        return scale;
+    }
+
+  private:
+    // Позиций в одном блоке: оценки блока помещаются в кэш L1
+    static constexpr size_t BLOCK = 512;
+    // Ширина векторных регистров (float): циклы по блоку записаны так, чтобы компилятор их векторизовал
+    static constexpr size_t LANES = 8;
+
+    static void flatten(const eval_weights &w, float flat[2 * TERMS_COUNT])
+    {
+        for (int t = 0; t < TERMS_COUNT; ++t)
+        {
+            flat[t] = float(w.mg[t]);
+            flat[TERMS_COUNT + t] = float(w.eg[t]);
+        }
+    }
+
+    // Делит позиции [0, padded) на отрезки по числу потоков (границы кратны LANES) и обрабатывает их параллельно
+    void parallel(const function<void(size_t, size_t)> &work) const
+    {
+        const size_t part = (padded / LANES + threads_count - 1) / threads_count * LANES;
+        vector<thread> workers;
+        for (size_t from = 0; from < padded; from += part)
+            workers.emplace_back(work, from, min(padded, from + part));
+        for (auto &th : workers)
+            th.join();
+    }
+
+    // Ошибка на весах w; если grad не nullptr, в него записывается градиент ошибки по весам
+    double run(const float w[2 * TERMS_COUNT], double *grad) const
+    {
+        vector<double> losses(threads_count + 1, 0);
+        vector<array<double, 2 * TERMS_COUNT>> grads(threads_count + 1);
+        const size_t part = (padded / LANES + threads_count - 1) / threads_count * LANES;
+        parallel([&](const size_t from, const size_t to) {
+            const size_t index = from / max(part, size_t(1));
+            grads[index].fill(0);
+            losses[index] = partial(w, from, to, grad ? grads[index].data() : nullptr);
+        });
+        double total = 0;
+        if (grad)
+            fill(grad, grad + 2 * TERMS_COUNT, 0.0);
+        for (size_t i = 0; i <= threads_count; ++i)
+        {
+            total += losses[i];
+            for (int k = 0; grad && k < 2 * TERMS_COUNT; ++k)
+                grad[k] += grads[i][k];
+        }
+        const double n = double(max(size, size_t(1)));
+        for (int k = 0; grad && k < 2 * TERMS_COUNT; ++k)
+            grad[k] /= n;
+        return total / n;
+    }
+
+    // Сумма квадратов ошибок на отрезке [from, to) и (если grad не nullptr) сумма градиентов
+    double partial(const float w[2 * TERMS_COUNT], const size_t from, const size_t to, double *grad) const
+    {
+        float score[BLOCK], err[BLOCK];
+        double total = 0;
+        const float k = float(scale);
+        for (size_t start = from; start < to; start += BLOCK)
+        {
+            const size_t n = min(BLOCK, to - start);
+            const float *ph = phase.data() + start;
+            const float *res = label.data() + start;
+            // Оценка: сумма по признакам (eg + (mg - eg) * фаза) * значение признака
+            fill(score, score + n, 0.0f);
+            for (int t = 0; t < TERMS_COUNT; ++t)
+            {
+                const int16_t *f = feats[t].data() + start;
+                const float mg = w[t], eg = w[TERMS_COUNT + t];
+                for (size_t i = 0; i < n; ++i)
+                    score[i] += (eg + (mg - eg) * ph[i]) * float(f[i]);
+            }
+            float sum[LANES] = {};
+            for (size_t i = 0; i < n; ++i)
+            {
+                const float p = 1.0f / (1.0f + exp(-k * score[i]));
+                const float e = p - res[i];
+                sum[i % LANES] += e * e;
+                // Производная ошибки по оценке (без множителя 2 * scale, он общий)
+                err[i] = e * p * (1.0f - p);
+            }
+            for (size_t l = 0; l < LANES; ++l)
+                total += sum[l];
+            if (!grad)
+                continue;
+            for (int t = 0; t < TERMS_COUNT; ++t)
+            {
+                const int16_t *f = feats[t].data() + start;
+                float g_mg[LANES] = {}, g_eg[LANES] = {};
+                for (size_t i = 0; i < n; i += LANES)
+                {
+                    for (size_t l = 0; l < LANES; ++l)
+                    {
+                        const float d = err[i + l] * float(f[i + l]);
+                        g_mg[l] += d * ph[i + l];
+                        g_eg[l] += d - d * ph[i + l];
+                    }
+                }
+                for (size_t l = 0; l < LANES; ++l)
+                {
+                    grad[t] += 2.0 * k * g_mg[l];
+                    grad[TERMS_COUNT + t] += 2.0 * k * g_eg[l];
+                }
+            }
+        }
+        return total;
+    }
+
+  private:
+    unsigned threads_count;
+    size_t size = 0;                    // Количество позиций
+    size_t padded = 0;                  // Длина массивов (кратна LANES)
+    vector<int16_t> feats[TERMS_COUNT]; // Значения признаков по позициям (структура массивов)
+    vector<float> phase;                // Фаза позиции, от 0 (эндшпиль) до 1 (начало партии)
+    vector<float> label;                // Результат партии для белых: 0, 0.5 или 1
+    double scale = 0.01;                // Коэффициент перевода оценки в вероятность выигрыша
+};
@@ -0,0 +1,144 @@
+#pragma once
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "../Models/Packed.h"
+#include "../Models/Search.h"
+#include "Config.h"
+#include "Logic.h"
+#include "Match.h"
+#include "Net.h"
+#include "SelfPlay.h"
+
+using namespace std;
+
+// Записи партии в виде шестнадцатеричной строки (для передачи в JSON)
+inline string records_to_hex(const vector<training_record> &records)
+{
+    static const char digits[] = "0123456789abcdef";
+    const uint8_t *bytes = reinterpret_cast<const uint8_t *>(records.data());
+    string res(records.size() * sizeof(training_record) * 2, '0');
+    for (size_t i = 0; i < records.size() * sizeof(training_record); ++i)
+    {
+        res[2 * i] = digits[bytes[i] >> 4];
+        res[2 * i + 1] = digits[bytes[i] & 15];
+    }
+    return res;
+}
+
+// Обратное преобразование; бросает runtime_error на неверной строке
+inline vector<training_record> records_from_hex(const string &hex)
+{
+    if (hex.size() % (2 * sizeof(training_record)))
+        throw runtime_error("bad records");
+    vector<training_record> res(hex.size() / (2 * sizeof(training_record)));
+    uint8_t *bytes = reinterpret_cast<uint8_t *>(res.data());
+    auto digit = [](const char c) {
+        if (c >= '0' && c <= '9')
+            return c - '0';
+        if (c >= 'a' && c <= 'f')
+            return c - 'a' + 10;
+        throw runtime_error("bad records");
+    };
+    for (size_t i = 0; i < hex.size() / 2; ++i)
+        bytes[i] = uint8_t(digit(hex[2 * i]) * 16 + digit(hex[2 * i + 1]));
+    return res;
+}
+
+// Рабочий процесс распределенной работы: подключается к координатору (Game/Coordinator.h), получает единицы
+// работы (несколько партий самоигры или матча с настройками бота) и возвращает их результаты
+// Протокол (строки JSON):
+//   рабочий -> {"type": "ready"}, затем {"type": "result", "id": N, "games": [...], ...} на каждую единицу
+//   координатор -> {"type": "unit", "id": N, "job": "selfplay"|"match", "first": I, "count": K, "bot": {...},
+//                   "depth": D, "nodes": B, "random_plies": R, "max_plies": M, "seed": S} или {"type": "done"}
+class Worker
+{
+  public:
+    explicit Worker(const string &address) : address(address)
+    {
+    }
+
+    // Работает до сообщения done или разрыва соединения; возвращает количество выполненных единиц
+    // Координатор может еще не слушать: подключение повторяется раз в секунду до connect_attempts раз
+    size_t run(const int connect_attempts = 30)
+    {
+        LineSocket sock;
+        for (int attempt = 1;; ++attempt)
+        {
+            try
+            {
+                sock = LineSocket::connect_to(address);
+                break;
+            }
+            catch (const exception &)
+            {
+                if (attempt >= connect_attempts)
+                    throw;
+                this_thread::sleep_for(chrono::seconds(1));
+            }
+        }
+        size_t units = 0;
+        if (!sock.send_line(json{{"type", "ready"}}.dump()))
+            return units;
+        string line;
+        while (sock.read_line(line))
+        {
+            const json msg = json::parse(line);
+            if (msg.value("type", "") == "done")
+                break;
+            if (msg.value("type", "") != "unit")
+                continue;
+            if (!sock.send_line(run_unit(msg).dump()))
+                break;
+            ++units;
+        }
+        return units;
+    }
+
+    // Выполняет единицу работы и возвращает сообщение с результатом
+    // Настройки бота - из settings.json рабочего, поверх них - настройки "bot" из единицы
+    static json run_unit(const json &unit)
+    {
+        Config config;
+        const json bot = unit.value("bot", json::object());
+        for (auto &item : bot.items())
+            config.set("Bot", item.key(), item.value());
+        config.set_default("Bot", "BotScoringType", "NumberAndPotential");
+        config.set_default("Bot", "Optimization", "O1");
+        search_limits limits;
+        limits.depth = unit.value("depth", -1);
+        limits.nodes = unit.value("nodes", int64_t(-1));
+        const int random_plies = unit.value("random_plies", 8), max_plies = unit.value("max_plies", 200);
+        const size_t first = unit.at("first"), count = unit.at("count");
+
+        json res = {{"type", "result"}, {"id", unit.at("id")}, {"games", json::array()}};
+        if (unit.value("job", "") == "match")
+        {
+            Match match(&config, limits, random_plies, max_plies);
+            for (size_t index = first; index < first + count; ++index)
+                res["games"].push_back({{"index", index}, {"result", match.play(index)}});
+            res["ab_ms"] = match.ab_ms;
+            res["mcts_ms"] = match.mcts_ms;
+            res["ab_moves"] = match.ab_moves;
+            res["mcts_moves"] = match.mcts_moves;
+            res["ab_nodes"] = match.ab_nodes;
+        }
+        else
+        {
+            SelfPlay selfplay(&config, limits, random_plies, max_plies, 1, unit.value("seed", 0u));
+            Logic logic(&config);
+            vector<training_record> records;
+            for (size_t index = first; index < first + count; ++index)
+            {
+                selfplay.play(logic, index, records);
+                res["games"].push_back({{"index", index}, {"records", records_to_hex(records)}});
+            }
+        }
+        return res;
+    }
+
+  private:
+    string address;
+};
@@ -0,0 +1,14 @@
+#pragma once
+
+// Состояния автомата партии (Game::step)
+enum class GameState
+{
+    START,      // Начало партии (в том числе повтор после кнопки "Повтор игры")
+    NEXT_TURN,  // Переход хода: проверка конца партии и выбор, кто ходит
+    PLAYER,     // Ход человека: ожидание кликов (фигура, поле, продолжение серии взятий)
+    BOT_THINK,  // Бот ищет ход в отдельном потоке
+    BOT_MOVE,   // Найденная серия выполняется на доске с задержкой BotDelayMS между ходами
+    FINISH,     // Конец партии: запись в лог и в PDN
+    FINAL,      // Финальный экран: ожидание повтора игры или закрытия окна
+    DONE        // Игра окончена
+};
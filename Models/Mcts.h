@@ -0,0 +1,26 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+#include "Move.h"
+
+// Узел дерева поиска Монте-Карло (Game/Mcts.h)
+// Узлы берутся из заранее выделенного пула, дети узла лежат в пуле подряд (first_child, child_count)
+// Все счетчики атомарны: дерево растят и обходят несколько потоков одновременно
+struct mcts_node
+{
+    full_move move;                        // Ход, которым пришли в узел (у корня не задан)
+    std::atomic<uint32_t> visits{0};       // Сколько случайных партий прошло через узел
+    std::atomic<uint32_t> virtual_loss{0}; // Сколько потоков сейчас спускаются через узел (считаются проигрышами)
+    std::atomic<uint64_t> score{0};        // Сумма результатов для стороны, сделавшей move: 2 - выигрыш, 1 - ничья, 0 - проигрыш
+    std::atomic<uint32_t> first_child{0};  // Номер первого ребенка в пуле
+    std::atomic<uint32_t> child_count{0};  // Количество детей
+    std::atomic<uint8_t> state{0};         // 0 - не раскрыт, 1 - раскрывается, 2 - раскрыт (без детей - конец партии)
+};
+
+// Способ выбора ходов в случайных партиях (MctsPolicy)
+enum class PlayoutPolicy
+{
+    RANDOM,   // Равновероятно
+    CAPTURES  // Чаще длинные серии взятий и ходы с превращением в дамку
+};
@@ -1,10 +1,16 @@
 #pragma once
 #include <stdlib.h>
+#include <array>
+#include <cassert>
+#include <cstdint>
 
 // Определяем тип для координат позиций на доске
 // int8_t используется для экономии памяти (значения от -128 до 127)
 typedef int8_t POS_T;
 
+// Доска фиксированного размера для поиска: копируется без выделения памяти в куче
+typedef std::array<std::array<POS_T, 8>, 8> BOARD_T;
+
 // Структура, описывающая ход в шашках
 struct move_pos
 {
@@ -12,6 +18,11 @@ struct move_pos
     POS_T x2, y2;           // Конечная позиция фигуры (куда ходим)
     POS_T xb = -1, yb = -1; // Позиция побитой фигуры (по умолчанию -1 = нет взятия)
 
+    // Пустой ход (нужен для буферов ходов фиксированного размера, см. move_list)
+    move_pos() : x(-1), y(-1), x2(-1), y2(-1)
+    {
+    }
+
     // Конструктор для обычного хода без взятия
     // Использует список инициализации для эффективности
     move_pos(const POS_T x, const POS_T y, const POS_T x2, const POS_T y2) : x(x), y(y), x2(x2), y2(y2)
@@ -40,3 +51,127 @@ struct move_pos
         return !(*this == other);
     }
 };
+
+// Максимальное количество элементарных ходов в позиции
+// На свободное поле можно прийти не более чем с 4 направлений (по одной фигуре с каждого),
+// а свободных полей не больше 31, поэтому обычных ходов, как и взятий, не больше 124
+// Столько же места отводится под полные ходы (серий взятий с разными результатами на практике намного меньше)
+const int MAX_TURNS = 128;
+
+// Максимальное количество взятий в одной серии: фигура на краю доски не может быть побита,
+// а внутренних темных полей 18
+const int MAX_BEATS = 18;
+
+// Полный ход: обычный ход или вся серия взятий одной фигуры как один ход
+struct full_move
+{
+    POS_T x = -1, y = -1;       // Откуда ходит фигура
+    POS_T x2 = -1, y2 = -1;     // Где она заканчивает ход
+    uint32_t beats = 0;         // Маска побитых фигур: бит (x * 8 + y) / 2 для каждого побитого поля
+    bool is_promotion = false;  // Шашка становится дамкой (в том числе посреди серии взятий)
+    uint8_t size = 0;           // Количество взятий (0 - обычный ход)
+    uint8_t path[MAX_BEATS];    // Поля остановки после каждого взятия (x * 8 + y)
+    uint8_t beat_path[MAX_BEATS]; // Побитые фигуры в порядке взятия (x * 8 + y)
+
+    // Раскладывает ход на элементарные ходы (для доски, нотации и главного варианта)
+    template <class List> void to_turns(List &res) const
+    {
+        if (size == 0)
+        {
+            res.emplace_back(x, y, x2, y2);
+            return;
+        }
+        POS_T cur_x = x, cur_y = y;
+        for (uint8_t i = 0; i < size; ++i)
+        {
+            res.emplace_back(cur_x, cur_y, POS_T(path[i] / 8), POS_T(path[i] % 8), POS_T(beat_path[i] / 8),
+                             POS_T(beat_path[i] % 8));
+            cur_x = POS_T(path[i] / 8);
+            cur_y = POS_T(path[i] % 8);
+        }
+    }
+
+    // Одинаковый результат: та же фигура, то же конечное поле, те же побитые фигуры
+    bool is_same_result(const full_move &other) const
+    {
+        return x == other.x && y == other.y && x2 == other.x2 && y2 == other.y2 && beats == other.beats;
+    }
+};
+
+// Список фиксированной емкости: хранится на стеке или в памяти поиска, память в куче не выделяет
+// Повторяет нужную часть интерфейса vector, чтобы генератор ходов работал с обоими контейнерами
+template <class T, size_t N> struct fixed_list
+{
+    T items[N];
+    size_t count = 0;
+
+    void clear()
+    {
+        count = 0;
+    }
+
+    // Переполнение проверяется только в отладочной сборке: ходов в позиции не больше MAX_TURNS
+    void push_back(const T &item)
+    {
+        assert(count < N);
+        items[count++] = item;
+    }
+
+    template <class... Args> void emplace_back(const Args... args)
+    {
+        assert(count < N);
+        items[count++] = T(args...);
+    }
+
+    // Удаляет элементы [first, last), сдвигая оставшиеся к началу
+    void erase(T *first, T *last)
+    {
+        T *dst = first;
+        for (T *src = last; src != end(); ++src)
+            *dst++ = *src;
+        count = size_t(dst - items);
+    }
+
+    bool empty() const
+    {
+        return count == 0;
+    }
+
+    size_t size() const
+    {
+        return count;
+    }
+
+    T *begin()
+    {
+        return items;
+    }
+
+    T *end()
+    {
+        return items + count;
+    }
+
+    const T *begin() const
+    {
+        return items;
+    }
+
+    const T *end() const
+    {
+        return items + count;
+    }
+
+    T &operator[](const size_t i)
+    {
+        return items[i];
+    }
+
+    const T &operator[](const size_t i) const
+    {
+        return items[i];
+    }
+};
+
+typedef fixed_list<move_pos, MAX_TURNS> turn_list;   // Элементарные ходы
+typedef fixed_list<full_move, MAX_TURNS> move_list;  // Полные ходы
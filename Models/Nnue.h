@@ -0,0 +1,18 @@
+#pragma once
+#include <cstdint>
+
+// Размеры нейросети оценки (режим BotScoringType = "Nnue", см. Game/Nnue.h)
+// Входы: фигура (своя/чужая шашка/дамка) на одном из 32 темных полей с точки зрения одной из сторон
+const int NNUE_INPUTS = 4 * 32;
+const int NNUE_HIDDEN = 32;   // Нейронов первого слоя на одну сторону (накопитель)
+const int NNUE_L2 = 16;       // Нейронов второго слоя
+const int NNUE_BUCKETS = 4;   // Наборов линейной части (выбирается по количеству фигур на доске)
+
+// Накопитель первого слоя для обеих сторон: суммы весов входов, которые обновляются по ходу
+// Индекс стороны: 0 - с точки зрения белых, 1 - с точки зрения черных (доска повернута)
+struct alignas(32) nnue_acc
+{
+    int16_t values[2][NNUE_HIDDEN];  // Первый слой (до активации)
+    int32_t psqt[2][NNUE_BUCKETS];   // Линейная часть "фигура-поле" для каждого набора
+    uint8_t count[2] = {};           // Количество фигур белых и черных
+};
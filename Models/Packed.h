@@ -0,0 +1,82 @@
+#pragma once
+#include <cstdint>
+
+#include "Move.h"
+
+// Упакованная позиция для наборов данных (подбор весов оценки)
+// Темные поля нумеруются от 0 до 31 по рядам: поле i - клетка mtx[i / 4][2 * (i % 4) + (i / 4 + 1) % 2]
+// Файл набора: "CKP1", размер записи (uint32), затем записи подряд в порядке байтов машины
+struct packed_position
+{
+    uint32_t white = 0;  // Поля с белыми фигурами (бит i - темное поле i)
+    uint32_t black = 0;  // Поля с черными фигурами
+    uint32_t kings = 0;  // Поля с дамками (обоих цветов)
+    uint8_t color = 0;   // Очередь хода (0 - белые, 1 - черные)
+    uint8_t result = 0;  // Результат партии для белых: 0 - поражение, 1 - ничья, 2 - победа
+    uint16_t ply = 0;    // Номер полухода в партии
+};
+static_assert(sizeof(packed_position) == 16, "packed_position must be 16 bytes");
+
+// Номер темного поля по координатам матрицы
+inline int square_index(const POS_T x, const POS_T y)
+{
+    return x * 4 + y / 2;
+}
+
+// Упаковывает позицию (vector<vector<POS_T>> или BOARD_T)
+template <class Matrix> packed_position pack_position(const Matrix &mtx, const bool color, const uint8_t result)
+{
+    packed_position res;
+    for (POS_T x = 0; x < 8; ++x)
+    {
+        for (POS_T y = (x + 1) % 2; y < 8; y += 2)
+        {
+            const uint32_t bit = uint32_t(1) << square_index(x, y);
+            if (!mtx[x][y])
+                continue;
+            (mtx[x][y] % 2 ? res.white : res.black) |= bit;
+            if (mtx[x][y] > 2)
+                res.kings |= bit;
+        }
+    }
+    res.color = color;
+    res.result = result;
+    return res;
+}
+
+// Распаковывает позицию в доску фиксированного размера
+inline BOARD_T unpack_position(const packed_position &pos)
+{
+    BOARD_T mtx{};
+    for (int i = 0; i < 32; ++i)
+    {
+        const uint32_t bit = uint32_t(1) << i;
+        if (!((pos.white | pos.black) & bit))
+            continue;
+        const POS_T x = POS_T(i / 4), y = POS_T(2 * (i % 4) + (i / 4 + 1) % 2);
+        mtx[x][y] = POS_T((pos.white & bit ? 1 : 2) + (pos.kings & bit ? 2 : 0));
+    }
+    return mtx;
+}
+
+// Пачка позиций в виде структуры массивов (для векторной оценки листьев, см. Game/LeafBatch.h)
+struct alignas(32) leaf_batch
+{
+    uint32_t white[MAX_TURNS];
+    uint32_t black[MAX_TURNS];
+    uint32_t kings[MAX_TURNS];
+    size_t size = 0;
+};
+
+// Запись обучающего набора из партий бота с самим собой (Game/SelfPlay.h): позиция, оценка поиска и лучший ход
+// Файл: "CKT1", размер записи (uint32), затем блоки: количество записей, способ сжатия (0 - без сжатия, 1 - zlib)
+// и размер данных блока (по uint32), затем данные блока
+struct training_record
+{
+    packed_position pos;   // Позиция, очередь хода, результат партии для белых и номер полухода
+    int16_t score = 0;     // Оценка поиска с точки зрения ходящей стороны (выигрыш - ±32000)
+    uint8_t from = 0;      // Лучший ход: темное поле, откуда ходит фигура
+    uint8_t to = 0;        // Темное поле, где она заканчивает ход
+    uint32_t beats = 0;    // Побитые фигуры (бит - номер темного поля)
+};
+static_assert(sizeof(training_record) == 24, "training_record must be 24 bytes");
@@ -0,0 +1,82 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "Move.h"
+#include "Nnue.h"
+#include "Packed.h"
+
+// Ограничения поиска для итеративного углубления (Logic::search)
+// Значение -1 означает, что ограничение не задано
+struct search_limits
+{
+    int depth = -1;        // Максимальный уровень бота (глубина расчета = depth + 1)
+    int movetime_ms = -1;  // Время на ход в миллисекундах
+    bool infinite = false; // Искать до команды остановки (анализ, размышление на времени соперника)
+    int64_t nodes = -1;    // Бюджет позиций: не зависит от скорости машины, поэтому сила игры везде одинакова
+};
+
+// Строка анализа: ход из корня, его оценка и главный вариант
+struct pv_line
+{
+    std::vector<move_pos> turns;  // Ход из корня (серия взятий целиком)
+    int score = 0;                // Точная оценка хода с точки зрения ходящей стороны
+    std::vector<move_pos> pv;     // Главный вариант начиная с turns (элементарные ходы всех полуходов подряд)
+};
+
+// Результат одной завершенной итерации поиска
+struct search_info
+{
+    int depth = 0;                // Уровень, на котором завершена итерация
+    int score = 0;                // Оценка лучшего хода с точки зрения ходящей стороны
+    uint64_t nodes = 0;           // Количество просмотренных позиций с начала поиска
+    int time_ms = 0;              // Время с начала поиска в миллисекундах
+    std::vector<move_pos> pv;     // Главный вариант лучшего хода
+    std::vector<pv_line> lines;   // Лучшие ходы по убыванию оценки (Logic::multi_pv строк)
+};
+
+// Максимальная высота стека рекурсии поиска в полуходах (на уровне 64 - 65 полуходов)
+const int MAX_HEIGHT = 128;
+
+// Память поиска одного потока: буферы ходов, треугольная таблица главных вариантов, накопители нейросети и хеши
+// для каждого полухода. Выделяется один раз вместе с Logic, сам поиск память в куче не выделяет
+struct search_arena
+{
+    move_list turns[MAX_HEIGHT];            // Ходы узла на высоте h
+    nnue_acc nnue[MAX_HEIGHT];              // Накопитель нейросети для позиции на высоте h (режим Nnue)
+    uint64_t hash[MAX_HEIGHT] = {};         // Хеш позиции на высоте h (при включенном кэше оценок)
+    leaf_batch leaves;                      // Дети узла перед листьями (пакетная оценка, нужна одна на поиск)
+    alignas(32) int32_t leaf_scores[MAX_TURNS];  // Их оценки с точки зрения белых
+    full_move pv[MAX_HEIGHT][MAX_HEIGHT];   // Главный вариант из узла на высоте h
+    size_t pv_size[MAX_HEIGHT] = {};        // Длина главного варианта на высоте h
+};
+
+// Результат решателя (Game/Solver.h) для стороны, которая ходит в позиции
+enum class SolveResult
+{
+    WIN,      // Выигрыш доказан: есть форсированный вариант при любой защите
+    LOSS,     // Проигрыш доказан
+    DRAW,     // Ни одна сторона не может форсировать выигрыш за заданное число полуходов
+    UNKNOWN   // Бюджет позиций исчерпан до доказательства
+};
+
+struct solve_info
+{
+    SolveResult result = SolveResult::UNKNOWN;
+    int plies = 0;                // Длина решения в полуходах (для выигрыша и проигрыша)
+    uint64_t nodes = 0;           // Количество просмотренных позиций
+    int time_ms = 0;              // Время решения в миллисекундах
+    std::vector<move_pos> line;   // Решение: элементарные ходы всех полуходов подряд (лучшая защита - самая долгая)
+};
+
+// Запись кэша анализа (Game/AnalysisCache.h): результат поиска из корня, 24 байта
+struct analysis_entry
+{
+    uint64_t key = 0;        // Хеш позиции (Zobrist с очередью хода) с солью оценки
+    int32_t score = 0;       // Оценка лучшего хода с точки зрения ходящей стороны
+    int16_t depth = -1;      // Уровень поиска (Logic::Max_depth), -1 - пустая запись
+    uint8_t from = 0, to = 0;  // Лучший ход: начальное и конечное поле (square_index)
+    uint32_t beats = 0;      // Маска побитых фигур лучшего хода
+    uint32_t check = 0;      // Контрольная сумма остальных полей (запись, оборванная падением, отбрасывается)
+};
+static_assert(sizeof(analysis_entry) == 24, "analysis_entry must be 24 bytes");
@@ -0,0 +1,42 @@
+#pragma once
+#include <cstdint>
+
+// Признаки оценочной функции (режим BotScoringType = "Weights")
+// У каждого признака два веса: для начала партии и для эндшпиля, итоговая оценка интерполируется по фазе
+// Значение признака - разность количества у белых и у черных (для права хода: +1, если ходят белые)
+enum eval_term : int
+{
+    TERM_MAN = 0,      // Шашка
+    TERM_KING,         // Дамка
+    TERM_ADVANCE,      // Шашка: за каждый пройденный к дамочному полю ряд
+    TERM_BACK_RANK,    // Шашка на своем первом ряду (охраняет поля превращения противника)
+    TERM_CENTER,       // Фигура на одном из 8 центральных полей (c3-f6)
+    TERM_TEMPO,        // Право хода
+    TERM_MOBILITY,     // Обычный ход (без взятия), доступный фигуре
+    TERM_RUNAWAY,      // Проходная шашка: впереди нет фигур противника, способных ее задержать
+    TERM_KING_VS_MEN,  // Есть дамка, а у противника дамок нет
+    TERMS_COUNT
+};
+
+// Названия признаков в файле весов
+const char *const eval_term_names[TERMS_COUNT] = {"Man",      "King",   "Advance",  "BackRank", "Center",
+                                                  "Tempo",    "Mobility", "Runaway", "KingVsMen"};
+
+// Фаза партии: шашка - 1, дамка - 2, не больше PHASE_MAX (начальная позиция - PHASE_MAX, пустая доска - 0)
+const int PHASE_MAX = 24;
+
+// Веса оценочной функции в сотых долях шашки
+struct eval_weights
+{
+    int mg[TERMS_COUNT] = {100, 300, 3, 10, 8, 4, 2, 20, 0};    // Начало партии (фаза PHASE_MAX)
+    int eg[TERMS_COUNT] = {100, 400, 8, 0, 2, 0, 3, 60, 150};   // Эндшпиль (фаза 0)
+};
+
+// Накопитель оценки: суммы весов по фигурам и количество фигур
+// Обновляется по ходу (Evaluator::update) без пересчета всей доски
+struct eval_acc
+{
+    int mg = 0, eg = 0;      // Сумма весов фигур за белых минус за черных
+    int phase = 0;           // Фаза без ограничения сверху
+    uint8_t count[5] = {};   // Количество фигур каждого типа (индекс - значение клетки доски)
+};
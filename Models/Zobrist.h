@@ -0,0 +1,61 @@
+#pragma once
+#include <cstdint>
+
+#include "Move.h"
+
+// Ключи Zobrist: случайное 64-битное число для каждой фигуры на каждом поле и для очереди хода
+// Хеш позиции - XOR ключей всех фигур (и ключа side, если ходят черные); при ходе пересчитывается за O(1)
+struct zobrist_keys
+{
+    uint64_t piece[5][64];  // Ключ фигуры type на поле x * 8 + y
+    uint64_t side;          // Ключ хода черных
+
+    // Ключи фиксированы (splitmix64 от постоянного зерна): хеши одинаковы во всех запусках
+    zobrist_keys()
+    {
+        uint64_t seed = 0x9E3779B97F4A7C15ull;
+        for (auto &keys : piece)
+        {
+            for (auto &key : keys)
+                key = next(seed);
+        }
+        side = next(seed);
+    }
+
+  private:
+    static uint64_t next(uint64_t &seed)
+    {
+        uint64_t z = (seed += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+};
+
+inline const zobrist_keys zobrist;
+
+// Хеш позиции (vector<vector<POS_T>> или BOARD_T) с очередью хода color
+template <class Matrix> uint64_t zobrist_hash(const Matrix &mtx, const bool color)
+{
+    uint64_t hash = (color ? zobrist.side : 0);
+    for (POS_T x = 0; x < 8; ++x)
+    {
+        for (POS_T y = 0; y < 8; ++y)
+        {
+            if (mtx[x][y])
+                hash ^= zobrist.piece[mtx[x][y]][x * 8 + y];
+        }
+    }
+    return hash;
+}
+
+// Хеш позиции после хода move из позиции mtx с хешем hash
+template <class Matrix> uint64_t zobrist_update(uint64_t hash, const Matrix &mtx, const full_move &move)
+{
+    const POS_T type = mtx[move.x][move.y];
+    hash ^= zobrist.piece[type][move.x * 8 + move.y];
+    for (uint8_t i = 0; i < move.size; ++i)
+        hash ^= zobrist.piece[mtx[move.beat_path[i] / 8][move.beat_path[i] % 8]][move.beat_path[i]];
+    hash ^= zobrist.piece[type + (move.is_promotion ? 2 : 0)][move.x2 * 8 + move.y2];
+    return hash ^ zobrist.side;
+}
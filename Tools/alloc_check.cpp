@@ -0,0 +1,89 @@
+#include <cstdlib>
+#include <new>
+
+#include "../Game/Engine.h"
+
+// Проверка: рекурсия поиска (find_best_turns_rec из каждого хода корня) не выделяет память
+// Собирается с CHECKERS_ALLOC_CHECK: Logic отмечает вход в рекурсию и выход из нее (ALLOC_CHECK_MARK),
+// а operator new считает выделения между отметками. Корень поиска (списки ходов, варианты) выделяет память
+// и не считается. Запускается ctest (add_test в CMakeLists.txt); код возврата 1 - рекурсия выделяет память
+
+static bool in_recursion = false;
+static size_t recursion_allocations = 0;
+static size_t total_allocations = 0;
+
+void alloc_check_mark(const bool entered)
+{
+    in_recursion = entered;
+}
+
+// GCC принимает free в замененном operator delete за несоответствие выделению через new
+#if defined(__GNUC__) && !defined(__clang__)
+    #pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void *operator new(size_t size)
+{
+    ++total_allocations;
+    if (in_recursion)
+        ++recursion_allocations;
+    if (void *ptr = malloc(size ? size : 1))
+        return ptr;
+    throw bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept
+{
+    free(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept
+{
+    free(ptr);
+}
+
+int main()
+{
+    int failed = 0;
+    // Материальная оценка на обоих уровнях оптимизации с пакетной оценкой листьев и без нее, оценка по весам
+    const vector<tuple<string, string, bool>> modes = {{"NumberAndPotential", "O0", true},
+                                                       {"NumberAndPotential", "O0", false},
+                                                       {"NumberAndPotential", "O1", true},
+                                                       {"NumberAndPotential", "O1", false},
+                                                       {"Weights", "O1", false}};
+    for (auto &[scoring, optimization, batch] : modes)
+    {
+        Config config;
+        set_bench_config(config);
+        config.set("Bot", "BotScoringType", scoring);
+        config.set("Bot", "EvalWeights", "");  // Веса по умолчанию
+        config.set("Bot", "Optimization", optimization);
+        config.set("Bot", "BatchLeaves", batch);
+        const int depth = (optimization == "O0" ? 5 : 7);
+        uint64_t nodes = 0;
+        size_t total = 0;
+        const size_t before = recursion_allocations;
+        for (auto &fen : bench_fens)
+        {
+            vector<vector<POS_T>> mtx;
+            bool color;
+            parse_fen(fen, mtx, color);
+            const size_t start = total_allocations;
+            Logic logic(&config);
+            logic.Max_depth = depth;
+            logic.find_best_turns(mtx, color);
+            nodes += logic.nodes;
+            search_limits limits;
+            limits.depth = depth;
+            logic.search(mtx, color, limits);
+            nodes += logic.nodes;
+            total += total_allocations - start;
+        }
+        const size_t inside = recursion_allocations - before;
+        cout << scoring << " " << optimization << (batch ? " batch" : "") << ": " << nodes << " nodes, " << inside
+             << " allocations in the recursion, " << total << " in total" << (inside ? " - FAIL" : "") << "\n";
+        if (inside)
+            failed = 1;
+    }
+    return failed;
+}
@@ -0,0 +1,67 @@
+#include <chrono>
+#include <cstring>
+#include <fstream>
+
+#include "../Game/Analyzer.h"
+
+// Пакетный анализ позиций
+// Использование: checkers_analyze [-i input.fen] [-o output.txt] [-j threads] [-d level] [-n nodes] [-t movetime_ms] [-m multipv]
+// По умолчанию читает stdin, пишет в stdout, уровень 5, потоков по числу ядер
+int main(int argc, char* argv[])
+{
+    string input, output;
+    unsigned threads = 0;
+    size_t multi_pv = 1;
+    search_limits limits;
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (!strcmp(argv[i], "-i"))
+            input = argv[i + 1];
+        else if (!strcmp(argv[i], "-o"))
+            output = argv[i + 1];
+        else if (!strcmp(argv[i], "-j"))
+            threads = unsigned(atoi(argv[i + 1]));
+        else if (!strcmp(argv[i], "-d"))
+            limits.depth = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "-n"))
+            limits.nodes = atoll(argv[i + 1]);
+        else if (!strcmp(argv[i], "-t"))
+            limits.movetime_ms = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "-m"))
+            multi_pv = size_t(max(1, atoi(argv[i + 1])));
+        else
+        {
+            cerr << "Usage: " << argv[0] << " [-i input.fen] [-o output.txt] [-j threads] [-d level] [-n nodes] [-t movetime_ms] [-m multipv]\n";
+            return 1;
+        }
+    }
+    if (limits.depth < 0 && limits.nodes < 0 && limits.movetime_ms < 0)
+        limits.depth = 5;
+
+    Config config;
+    config.set_default("Bot", "BotScoringType", "NumberAndPotential");
+    config.set_default("Bot", "NoRandom", true);
+    config.set_default("Bot", "Optimization", "O1");
+
+    ifstream fin;
+    ofstream fout;
+    if (!input.empty())
+    {
+        fin.open(input);
+        if (!fin.is_open())
+        {
+            cerr << "Can't open " << input << "\n";
+            return 1;
+        }
+    }
+    if (!output.empty())
+        fout.open(output);
+
+    auto start = chrono::steady_clock::now();
+    Analyzer analyzer(&config, threads, limits, multi_pv);
+    size_t count = analyzer.run(input.empty() ? cin : fin, output.empty() ? cout : fout);
+    auto end = chrono::steady_clock::now();
+    double sec = chrono::duration<double>(end - start).count();
+    cerr << "Analyzed " << count << " positions in " << sec << " sec (" << count / max(sec, 1e-9) << " pos/sec)\n";
+    return 0;
+}
@@ -0,0 +1,270 @@
+#include <benchmark/benchmark.h>
+
+#include "../Game/Engine.h"
+#include "../Game/Mcts.h"
+#include "../Game/Notation.h"
+
+// Микробенчмарки горячих путей движка (Google Benchmark)
+// По умолчанию результаты выводятся в JSON, чтобы сравнивать коммиты между собой:
+//   checkers_bench --benchmark_out=bench.json
+// Все позиции фиксированы, настройки бота - как у команды bench движка (set_bench_config), а не из settings.json
+
+// Фиксированный набор позиций
+const string men_fen = "W:Wa1,a3,b2,c1,c3,d2,e1,e3,f2,g1,g3,h2:Ba7,b6,b8,c7,d6,d8,e7,f6,f8,g7,h6,h8";
+const string middle_fen = "W:Wa1,b2,c1,c3,d4,e1,e3,f2,g3,h2:Ba7,b6,b8,c7,d8,e5,e7,f8,g5,h6";
+const string kings_fen = "W:WKa1,Kc3,e1,g3,h2:BKh8,Kf6,b6,d8,a7";
+const string captures_fen = "B:Wb2,c3,d4,e3,f4,g3,h4,Ke5:Ba5,b4,c5,d6,f6,g5,h6,Kb8";
+
+// Настройки бота команды bench с заданным режимом оценки; веса и сеть - встроенные
+static void set_config(Config &config, const string &scoring_mode)
+{
+    set_bench_config(config);
+    config.set("Bot", "BotScoringType", scoring_mode);
+    config.set("Bot", "EvalWeights", "");
+    config.set("Bot", "NnueFile", "");
+}
+
+// Логика бота с заданным режимом оценки
+static Logic make_logic(Config &config, const string &scoring_mode)
+{
+    set_config(config, scoring_mode);
+    return Logic(&config);
+}
+
+static void BM_find_turns(benchmark::State &state, const string &fen)
+{
+    vector<vector<POS_T>> mtx;
+    bool color;
+    parse_fen(fen, mtx, color);
+    vector<move_pos> turns;
+    for (auto _ : state)
+    {
+        Logic::find_turns(color, mtx, turns);
+        benchmark::DoNotOptimize(turns.data());
+    }
+}
+BENCHMARK_CAPTURE(BM_find_turns, men, men_fen);
+BENCHMARK_CAPTURE(BM_find_turns, middle, middle_fen);
+BENCHMARK_CAPTURE(BM_find_turns, kings, kings_fen);
+BENCHMARK_CAPTURE(BM_find_turns, captures, captures_fen);
+
+// Полные ходы (серии взятий целиком) - генератор, которым пользуется поиск
+static void BM_find_moves(benchmark::State &state, const string &fen)
+{
+    vector<vector<POS_T>> mtx;
+    bool color;
+    parse_fen(fen, mtx, color);
+    BOARD_T board;
+    for (POS_T i = 0; i < 8; ++i)
+        for (POS_T j = 0; j < 8; ++j)
+            board[i][j] = mtx[i][j];
+    move_list moves;
+    for (auto _ : state)
+    {
+        Logic::find_moves(color, board, moves);
+        benchmark::DoNotOptimize(moves.items);
+    }
+}
+BENCHMARK_CAPTURE(BM_find_moves, men, men_fen);
+BENCHMARK_CAPTURE(BM_find_moves, kings, kings_fen);
+BENCHMARK_CAPTURE(BM_find_moves, captures, captures_fen);
+
+static void BM_make_turn(benchmark::State &state)
+{
+    vector<vector<POS_T>> mtx;
+    bool color;
+    parse_fen(middle_fen, mtx, color);
+    vector<move_pos> turns;
+    Logic::find_turns(color, mtx, turns);
+    const auto turn = turns[0];
+    for (auto _ : state)
+    {
+        auto res = Logic::make_turn(mtx, turn);
+        benchmark::DoNotOptimize(res.data());
+    }
+}
+BENCHMARK(BM_make_turn);
+
+static void BM_calc_score(benchmark::State &state, const string &scoring_mode)
+{
+    Config config;
+    Logic logic = make_logic(config, scoring_mode);
+    vector<vector<POS_T>> mtx;
+    bool color;
+    parse_fen(middle_fen, mtx, color);
+    for (auto _ : state)
+        benchmark::DoNotOptimize(logic.calc_score(mtx, color));
+}
+BENCHMARK_CAPTURE(BM_calc_score, NumberOnly, string("NumberOnly"));
+BENCHMARK_CAPTURE(BM_calc_score, NumberAndPotential, string("NumberAndPotential"));
+BENCHMARK_CAPTURE(BM_calc_score, Weights, string("Weights"));
+BENCHMARK_CAPTURE(BM_calc_score, Nnue, string("Nnue"));
+
+// Оценка по весам так, как ее считает поиск: накопитель обновляется по ходу, в листе досчитываются
+// подвижность, проходные шашки и право хода; одна итерация - все ходы из позиции
+static void BM_evaluate_incremental(benchmark::State &state, const string &fen)
+{
+    Evaluator evaluator;
+    vector<vector<POS_T>> mtx;
+    bool color;
+    parse_fen(fen, mtx, color);
+    BOARD_T board;
+    for (POS_T i = 0; i < 8; ++i)
+        for (POS_T j = 0; j < 8; ++j)
+            board[i][j] = mtx[i][j];
+    move_list moves;
+    Logic::find_moves(color, board, moves);
+    const eval_acc acc = evaluator.init(board);
+    for (auto _ : state)
+    {
+        for (auto &move : moves)
+        {
+            eval_acc new_acc = acc;
+            evaluator.update(new_acc, board, move);
+            benchmark::DoNotOptimize(evaluator.evaluate(Logic::make_move(board, move), new_acc, !color));
+        }
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * int64_t(moves.size()));
+}
+BENCHMARK_CAPTURE(BM_evaluate_incremental, middle, middle_fen);
+BENCHMARK_CAPTURE(BM_evaluate_incremental, kings, kings_fen);
+
+// То же для нейросети: копирование накопителя, его обновление по ходу и проход по слоям сети
+static void BM_nnue_incremental(benchmark::State &state, const string &fen)
+{
+    Evaluator evaluator;
+    Nnue network;
+    network.init_from(evaluator);
+    vector<vector<POS_T>> mtx;
+    bool color;
+    parse_fen(fen, mtx, color);
+    BOARD_T board;
+    for (POS_T i = 0; i < 8; ++i)
+        for (POS_T j = 0; j < 8; ++j)
+            board[i][j] = mtx[i][j];
+    move_list moves;
+    Logic::find_moves(color, board, moves);
+    nnue_acc acc;
+    network.refresh(board, acc);
+    for (auto _ : state)
+    {
+        for (auto &move : moves)
+        {
+            nnue_acc new_acc = acc;
+            network.update(new_acc, board, move);
+            benchmark::DoNotOptimize(network.evaluate(new_acc, !color));
+        }
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * int64_t(moves.size()));
+}
+BENCHMARK_CAPTURE(BM_nnue_incremental, middle, middle_fen);
+BENCHMARK_CAPTURE(BM_nnue_incremental, kings, kings_fen);
+
+// Оценка всех детей позиции одной пачкой (как в узле перед листьями) против calc_score для каждого ребенка
+static void BM_leaf_batch(benchmark::State &state, const string &fen, const bool batch)
+{
+    Config config;
+    Logic logic = make_logic(config, "NumberAndPotential");
+    vector<vector<POS_T>> mtx;
+    bool color;
+    parse_fen(fen, mtx, color);
+    BOARD_T board;
+    for (POS_T i = 0; i < 8; ++i)
+        for (POS_T j = 0; j < 8; ++j)
+            board[i][j] = mtx[i][j];
+    move_list moves;
+    Logic::find_moves(color, board, moves);
+    const packed_position parent = pack_position(board, color, 0);
+    leaf_batch leaves;
+    alignas(32) int32_t scores[MAX_TURNS];
+    for (auto _ : state)
+    {
+        if (batch)
+        {
+            fill_leaf_batch(parent, moves, leaves);
+            score_leaf_batch(leaves, 100, 500, 5, scores);
+            benchmark::DoNotOptimize(scores[0]);
+        }
+        else
+        {
+            for (auto &move : moves)
+                benchmark::DoNotOptimize(logic.calc_score(Logic::make_move(board, move), !color));
+        }
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * int64_t(moves.size()));
+}
+BENCHMARK_CAPTURE(BM_leaf_batch, middle_batch, middle_fen, true);
+BENCHMARK_CAPTURE(BM_leaf_batch, middle_scalar, middle_fen, false);
+BENCHMARK_CAPTURE(BM_leaf_batch, kings_batch, kings_fen, true);
+BENCHMARK_CAPTURE(BM_leaf_batch, kings_scalar, kings_fen, false);
+
+// Полный поиск хода на уровнях 3/5/7; nodes - количество просмотренных позиций за итерацию
+// Вариант scalar - без пакетной оценки листьев (BatchLeaves = false)
+// Каждая итерация - новый Logic (создается вне замера): иначе со второй итерации поиск шел бы
+// с окном стремления вокруг прошлой оценки и измерялся бы другой путь
+static void BM_find_best_turns(benchmark::State &state, const string &fen, const bool batch)
+{
+    Config config;
+    set_config(config, "NumberAndPotential");
+    config.set("Bot", "BatchLeaves", batch);
+    vector<vector<POS_T>> mtx;
+    bool color;
+    parse_fen(fen, mtx, color);
+    uint64_t nodes = 0;
+    unique_ptr<Logic> logic;
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        logic = make_unique<Logic>(&config);
+        logic->Max_depth = int(state.range(0));
+        state.ResumeTiming();
+        auto turns = logic->find_best_turns(mtx, color);
+        benchmark::DoNotOptimize(turns.data());
+        nodes += logic->nodes;
+    }
+    state.counters["nodes"] = benchmark::Counter(double(nodes) / double(state.iterations()));
+    state.counters["nps"] = benchmark::Counter(double(nodes), benchmark::Counter::kIsRate);
+}
+BENCHMARK_CAPTURE(BM_find_best_turns, men, men_fen, true)->Arg(3)->Arg(5)->Arg(7)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_find_best_turns, middle, middle_fen, true)->Arg(3)->Arg(5)->Arg(7)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_find_best_turns, kings, kings_fen, true)->Arg(3)->Arg(5)->Arg(7)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_find_best_turns, middle_scalar, middle_fen, false)->Arg(5)->Arg(7)->Unit(benchmark::kMillisecond);
+
+// Поиск MCTS из начальной позиции в 1/2/4/8 потоках (одно дерево); playouts - случайных партий в секунду
+static void BM_mcts(benchmark::State &state)
+{
+    Config config;
+    config.set("Bot", "NoRandom", true);
+    config.set("Bot", "MctsPolicy", "Captures");
+    config.set("Bot", "MctsExploration", 1.0);
+    config.set("Bot", "MctsPoolMB", 64);
+    config.set("Bot", "MctsPlayouts", 4000);
+    config.set("Bot", "MctsThreads", int(state.range(0)));
+    Mcts mcts(&config);
+    vector<vector<POS_T>> mtx;
+    bool color;
+    parse_fen(start_fen, mtx, color);
+    for (auto _ : state)
+        benchmark::DoNotOptimize(mcts.find_best_turns(mtx, color).data());
+    state.counters["playouts"] = benchmark::Counter(double(state.iterations()) * 4000, benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_mcts)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// Формат вывода по умолчанию - JSON (если не задан явно через --benchmark_format)
+int main(int argc, char **argv)
+{
+    vector<char *> args(argv, argv + argc);
+    bool has_format = false;
+    for (int i = 1; i < argc; ++i)
+        has_format |= (string(argv[i]).rfind("--benchmark_format", 0) == 0);
+    char json_format[] = "--benchmark_format=json";
+    if (!has_format)
+        args.push_back(json_format);
+    int args_count = int(args.size());
+    benchmark::Initialize(&args_count, args.data());
+    if (benchmark::ReportUnrecognizedArguments(args_count, args.data()))
+        return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,14 @@
+#include "../Game/Engine.h"
+
+// Консольный движок: текстовый протокол через stdin/stdout, без графического интерфейса
+// checkers_engine bench [depth] - только прогнать команду bench (подпись nodes и скорость) и выйти
+int main(int argc, char* argv[])
+{
+    Engine engine;
+    if (argc > 1 && string(argv[1]) == "bench")
+    {
+        engine.bench(argc > 2 ? stoi(argv[2]) : bench_depth);
+        return 0;
+    }
+    return engine.run();
+}
@@ -0,0 +1,160 @@
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+#ifndef _WIN32
+    #include <sys/wait.h>
+    #include <unistd.h>
+#endif
+
+#include "../Game/Coordinator.h"
+
+// Распределенная самоигра и матчи: координатор раздает партии рабочим процессам через TCP или Unix-сокет
+// Использование: checkers_farm coordinator [-a address] [-w local_workers] [-t selfplay|match] [-g games]
+//                                          [-u unit_games] [-l level] [-n nodes] [-r random_plies] [-m max_plies]
+//                                          [-o data.bin] [-b shuffle_records] [-d dedup_mb] [-s seed] [-p playouts]
+//                checkers_farm worker [-a address]
+// Координатор с -w N сам запускает N локальных рабочих; другие рабочие могут подключиться в любой момент.
+// Упавший рабочий не теряет партии: его единица работы достается другому
+// По умолчанию адрес 127.0.0.1:5555, самоигра 1000 партий уровня 3 по 10 партий на единицу в data.bin;
+// матч (MCTS против альфа-беты) - 20 партий уровня 5 против 20000 случайных партий MCTS на ход
+static int usage(const char *name)
+{
+    cerr << "Usage: " << name
+         << " coordinator [-a address] [-w local_workers] [-t selfplay|match] [-g games] [-u unit_games] [-l level]"
+            " [-n nodes] [-r random_plies] [-m max_plies] [-o data.bin] [-b shuffle_records] [-d dedup_mb] [-s seed]"
+            " [-p playouts]\n"
+         << "       " << name << " worker [-a address]\n";
+    return 1;
+}
+
+#ifndef _WIN32
+// Запускает локального рабочего (тот же исполняемый файл с командой worker)
+static pid_t spawn_worker(const char *self, const string &address)
+{
+    const pid_t pid = fork();
+    if (pid == 0)
+    {
+        execl("/proc/self/exe", self, "worker", "-a", address.c_str(), static_cast<char *>(nullptr));
+        execlp(self, self, "worker", "-a", address.c_str(), static_cast<char *>(nullptr));
+        _exit(127);
+    }
+    return pid;
+}
+#endif
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2 || (strcmp(argv[1], "coordinator") && strcmp(argv[1], "worker")))
+        return usage(argv[0]);
+    const bool coordinator = !strcmp(argv[1], "coordinator");
+    string address = default_address, output = "data.bin";
+    size_t local_workers = 0, shuffle_records = 1000000, dedup_mb = 64;
+    farm_job job;
+    bool games_set = false;
+    for (int i = 2; i + 1 < argc; i += 2)
+    {
+        if (!strcmp(argv[i], "-a"))
+            address = argv[i + 1];
+        else if (!coordinator)
+            return usage(argv[0]);
+        else if (!strcmp(argv[i], "-w"))
+            local_workers = size_t(atoi(argv[i + 1]));
+        else if (!strcmp(argv[i], "-t"))
+            job.type = argv[i + 1];
+        else if (!strcmp(argv[i], "-g"))
+            job.games = size_t(atoll(argv[i + 1])), games_set = true;
+        else if (!strcmp(argv[i], "-u"))
+            job.unit_games = size_t(max(1, atoi(argv[i + 1])));
+        else if (!strcmp(argv[i], "-l"))
+            job.depth = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "-n"))
+            job.nodes = atoll(argv[i + 1]);
+        else if (!strcmp(argv[i], "-r"))
+            job.random_plies = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "-m"))
+            job.max_plies = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "-o"))
+            output = argv[i + 1];
+        else if (!strcmp(argv[i], "-b"))
+            shuffle_records = size_t(atoll(argv[i + 1]));
+        else if (!strcmp(argv[i], "-d"))
+            dedup_mb = size_t(atoll(argv[i + 1]));
+        else if (!strcmp(argv[i], "-s"))
+            job.seed = unsigned(atoi(argv[i + 1]));
+        else if (!strcmp(argv[i], "-p"))
+            job.bot["MctsPlayouts"] = atoi(argv[i + 1]);
+        else
+            return usage(argv[0]);
+    }
+    if (job.type != "selfplay" && job.type != "match")
+        return usage(argv[0]);
+    try
+    {
+        if (!coordinator)
+        {
+            const size_t units = Worker(address).run();
+            cerr << "Worker finished, units: " << units << "\n";
+            return 0;
+        }
+#ifdef _WIN32
+        throw runtime_error("checkers_farm requires a POSIX system");
+#else
+        const bool match = (job.type == "match");
+        if (job.depth < 0 && job.nodes < 0)
+            job.depth = (match ? 5 : 3);
+        if (match)
+        {
+            if (!games_set)
+                job.games = 20;
+            job.bot["NoRandom"] = true;
+            job.bot["MctsThreads"] = 1;
+            if (!job.bot.contains("MctsPlayouts"))
+                job.bot["MctsPlayouts"] = 20000;
+            // Пара партий из одного дебюта не должна делиться между единицами
+            job.unit_games += job.unit_games % 2;
+        }
+        else
+            job.bot["NoRandom"] = false;
+        job.bot["NodesPerSecond"] = 0;
+
+        auto start = chrono::steady_clock::now();
+        unique_ptr<TrainingWriter> writer;
+        if (!match)
+            writer = make_unique<TrainingWriter>(output, shuffle_records, dedup_mb, job.seed);
+        Coordinator farm(address, job, writer.get());
+        vector<pid_t> children;
+        for (size_t i = 0; i < local_workers; ++i)
+            children.push_back(spawn_worker(argv[0], address));
+        farm.run();
+        for (const pid_t pid : children)
+            waitpid(pid, nullptr, 0);
+        const double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        cerr << "Workers: " << farm.workers_seen << ", units requeued after worker loss: " << farm.requeued << "\n";
+        if (match)
+        {
+            const auto &r = farm.results;
+            cout << "MCTS vs alpha-beta: +" << r[2] << " =" << r[1] << " -" << r[0] << ", score "
+                 << (r[2] * 2 + r[1]) * 50 / max<uint64_t>(1, job.games) << "%\n";
+            cout << "Average move time: alpha-beta " << int(farm.ab_ms / double(max<uint64_t>(1, farm.ab_moves)))
+                 << " ms, MCTS " << int(farm.mcts_ms / double(max<uint64_t>(1, farm.mcts_moves))) << " ms\n";
+        }
+        else
+        {
+            writer->close();
+            cerr << "Games: " << job.games << ", positions: " << farm.positions
+                 << ", duplicates dropped: " << writer->duplicates << ", written: " << writer->written << " ("
+                 << writer->bytes / 1024 << " KB)\n";
+            cerr << "Time: " << int(seconds) << " s, "
+                 << uint64_t(double(farm.positions) * 3600 / max(seconds, 1e-3)) << " positions per hour\n";
+        }
+#endif
+    }
+    catch (const exception &e)
+    {
+        cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
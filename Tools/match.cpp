@@ -0,0 +1,69 @@
+#include <cstring>
+#include <iostream>
+
+#include "../Game/Match.h"
+
+// Матч бота MCTS против бота альфа-бета без графики
+// Использование: checkers_match [-g games] [-l level] [-n nodes] [-p playouts] [-t threads] [-c policy] [-r random_plies]
+//                               [-m max_plies]
+// По умолчанию 20 партий, альфа-бета уровня 5 против 20000 случайных партий MCTS на ход в одном потоке,
+// 4 случайных полухода дебюта, ничья после 120 полуходов. Остальные настройки ботов - из settings.json
+static int usage(const char *name)
+{
+    cerr << "Usage: " << name
+         << " [-g games] [-l level] [-n nodes] [-p playouts] [-t threads] [-c Random|Captures] [-r random_plies]"
+            " [-m max_plies]\n";
+    return 1;
+}
+
+int main(int argc, char *argv[])
+{
+    size_t games = 20;
+    int random_plies = 4, max_plies = 120;
+    search_limits limits;
+    Config config;
+    config.set_default("Bot", "BotScoringType", "NumberAndPotential");
+    config.set_default("Bot", "Optimization", "O1");
+    config.set("Bot", "NoRandom", true);
+    config.set_default("Bot", "MctsPlayouts", 20000);
+    config.set("Bot", "MctsThreads", 1);
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (!strcmp(argv[i], "-g"))
+            games = size_t(max(1, atoi(argv[i + 1])));
+        else if (!strcmp(argv[i], "-l"))
+            limits.depth = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "-n"))
+            limits.nodes = atoll(argv[i + 1]);
+        else if (!strcmp(argv[i], "-p"))
+            config.set("Bot", "MctsPlayouts", atoi(argv[i + 1]));
+        else if (!strcmp(argv[i], "-t"))
+            config.set("Bot", "MctsThreads", atoi(argv[i + 1]));
+        else if (!strcmp(argv[i], "-c"))
+            config.set("Bot", "MctsPolicy", string(argv[i + 1]));
+        else if (!strcmp(argv[i], "-r"))
+            random_plies = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "-m"))
+            max_plies = atoi(argv[i + 1]);
+        else
+            return usage(argv[0]);
+    }
+    if (limits.depth < 0 && limits.nodes < 0)
+        limits.depth = 5;
+
+    Match match(&config, limits, random_plies, max_plies);
+    int results[3] = {0, 0, 0};
+    for (size_t i = 0; i < games; ++i)
+    {
+        const int result = match.play(i);
+        ++results[result];
+        cout << "Game " << i + 1 << " (MCTS " << (i % 2 ? "black" : "white") << "): "
+             << (result == 2 ? "MCTS wins" : result == 0 ? "alpha-beta wins" : "draw") << endl;
+    }
+    cout << "MCTS vs alpha-beta: +" << results[2] << " =" << results[1] << " -" << results[0] << ", score "
+         << (results[2] * 2 + results[1]) * 50 / int(games) << "%\n";
+    cout << "Average move time: alpha-beta " << int(match.ab_ms / double(max<uint64_t>(1, match.ab_moves)))
+         << " ms (" << match.ab_nodes / max<uint64_t>(1, match.ab_moves) << " nodes), MCTS "
+         << int(match.mcts_ms / double(max<uint64_t>(1, match.mcts_moves))) << " ms\n";
+    return 0;
+}
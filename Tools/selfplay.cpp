@@ -0,0 +1,99 @@
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+#include "../Game/SelfPlay.h"
+
+// Генератор обучающих данных из партий бота с самим собой
+// Использование: checkers_selfplay -o data.bin [-g games] [-j threads] [-l level] [-n nodes] [-r random_plies]
+//                                  [-m max_plies] [-b shuffle_records] [-u dedup_mb] [-s seed]
+//                checkers_selfplay -i data.bin    - проверить файл и вывести количество записей и результаты
+// По умолчанию 1000 партий уровня 3, потоков по числу ядер, 8 случайных полуходов дебюта, ничья после 200 полуходов,
+// буфер перемешивания 1 млн записей, таблица повторов 64 Мб
+static int usage(const char *name)
+{
+    cerr << "Usage: " << name
+         << " -o data.bin [-g games] [-j threads] [-l level] [-n nodes] [-r random_plies] [-m max_plies]"
+            " [-b shuffle_records] [-u dedup_mb] [-s seed]\n"
+         << "       " << name << " -i data.bin\n";
+    return 1;
+}
+
+int main(int argc, char *argv[])
+{
+    string output, input;
+    size_t games = 1000, shuffle_records = 1000000, dedup_mb = 64;
+    unsigned threads = 0, seed = 0;
+    int random_plies = 8, max_plies = 200;
+    search_limits limits;
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (!strcmp(argv[i], "-o"))
+            output = argv[i + 1];
+        else if (!strcmp(argv[i], "-i"))
+            input = argv[i + 1];
+        else if (!strcmp(argv[i], "-g"))
+            games = size_t(atoll(argv[i + 1]));
+        else if (!strcmp(argv[i], "-j"))
+            threads = unsigned(atoi(argv[i + 1]));
+        else if (!strcmp(argv[i], "-l"))
+            limits.depth = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "-n"))
+            limits.nodes = atoll(argv[i + 1]);
+        else if (!strcmp(argv[i], "-r"))
+            random_plies = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "-m"))
+            max_plies = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "-b"))
+            shuffle_records = size_t(atoll(argv[i + 1]));
+        else if (!strcmp(argv[i], "-u"))
+            dedup_mb = size_t(atoll(argv[i + 1]));
+        else if (!strcmp(argv[i], "-s"))
+            seed = unsigned(atoi(argv[i + 1]));
+        else
+            return usage(argv[0]);
+    }
+    if (output.empty() == input.empty())
+        return usage(argv[0]);
+    try
+    {
+        if (!input.empty())
+        {
+            TrainingReader reader(input);
+            training_record record;
+            uint64_t count = 0, results[3] = {0, 0, 0};
+            while (reader.next(record))
+            {
+                ++count;
+                ++results[min<uint8_t>(record.pos.result, 2)];
+            }
+            cout << count << " positions, white wins " << results[2] << ", draws " << results[1] << ", black wins "
+                 << results[0] << "\n";
+            return 0;
+        }
+        if (limits.depth < 0 && limits.nodes < 0)
+            limits.depth = 3;
+        Config config;
+        config.set_default("Bot", "BotScoringType", "NumberAndPotential");
+        config.set_default("Bot", "Optimization", "O1");
+        config.set("Bot", "NoRandom", false);
+        config.set("Bot", "NodesPerSecond", 0);
+
+        auto start = chrono::steady_clock::now();
+        TrainingWriter writer(output, shuffle_records, dedup_mb, seed);
+        SelfPlay selfplay(&config, limits, random_plies, max_plies, threads, seed);
+        const uint64_t positions = selfplay.run(games, writer);
+        writer.close();
+        const double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        cerr << "Games: " << games << ", positions: " << positions << ", duplicates dropped: " << writer.duplicates
+             << ", written: " << writer.written << " (" << writer.bytes / 1024 << " KB)\n";
+        cerr << "Time: " << int(seconds) << " s, " << uint64_t(double(positions) * 3600 / max(seconds, 1e-3))
+             << " positions per hour\n";
+    }
+    catch (const exception &e)
+    {
+        cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
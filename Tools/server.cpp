@@ -0,0 +1,117 @@
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <iostream>
+
+#include "../Game/Server.h"
+
+// Сервер многих одновременных партий без графики (протокол - в Game/Server.h)
+// Использование: checkers_server [-a address] [-j threads]
+//                checkers_server load [-a address] [-g games] [-l level] [-t movetime_ms] [-m max_plies]
+// Режим load - нагрузочный клиент: открывает games партий бота с самим собой на одном соединении, ждет их конца
+// и выводит статистику сервера (задержки ходов p50/p99, просроченные ходы)
+// По умолчанию адрес 127.0.0.1:5555, потоков по числу ядер; load - 100 партий уровня 3 по 1000 мс на ход
+static int usage(const char *name)
+{
+    cerr << "Usage: " << name << " [-a address] [-j threads]\n"
+         << "       " << name << " load [-a address] [-g games] [-l level] [-t movetime_ms] [-m max_plies]\n";
+    return 1;
+}
+
+static atomic<bool> stop_server{false};
+
+static void on_signal(int)
+{
+    stop_server = true;
+}
+
+// Нагрузочный клиент
+static int load(const string &address, const size_t games, const int level, const int movetime_ms, const int max_plies)
+{
+    LineSocket sock = LineSocket::connect_to(address);
+    auto start = chrono::steady_clock::now();
+    for (size_t i = 0; i < games; ++i)
+        sock.send_line(json{{"type", "new"}, {"bot", "both"}, {"level", level}, {"movetime", movetime_ms},
+                            {"max_plies", max_plies}}
+                           .dump());
+    size_t over = 0, moves = 0, results[3] = {0, 0, 0};
+    string line;
+    while (over < games && sock.read_line(line))
+    {
+        const json msg = json::parse(line);
+        const string type = msg.value("type", "");
+        if (type == "bestmove")
+            ++moves;
+        else if (type == "over")
+        {
+            ++over;
+            const string result = msg.at("result");
+            ++results[result == "1-0" ? 2 : result == "0-1" ? 0 : 1];
+        }
+        else if (type == "error")
+            cerr << "Error: " << msg.value("message", "") << "\n";
+    }
+    const double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    sock.send_line(json{{"type", "stats"}}.dump());
+    while (sock.read_line(line))
+    {
+        const json msg = json::parse(line);
+        if (msg.value("type", "") != "stats")
+            continue;
+        cout << "Games: " << over << " (white +" << results[2] << " =" << results[1] << " -" << results[0]
+             << "), bot moves: " << moves << ", time: " << int(seconds) << " s\n";
+        cout << "Server: " << msg.dump() << "\n";
+        return 0;
+    }
+    return 1;
+}
+
+int main(int argc, char *argv[])
+{
+    const bool is_load = (argc > 1 && !strcmp(argv[1], "load"));
+    string address = default_address;
+    unsigned threads = 0;
+    size_t games = 100;
+    int level = 3, movetime_ms = 1000, max_plies = 200;
+    for (int i = is_load ? 2 : 1; i + 1 < argc; i += 2)
+    {
+        if (!strcmp(argv[i], "-a"))
+            address = argv[i + 1];
+        else if (!strcmp(argv[i], "-j") && !is_load)
+            threads = unsigned(atoi(argv[i + 1]));
+        else if (!strcmp(argv[i], "-g") && is_load)
+            games = size_t(atoll(argv[i + 1]));
+        else if (!strcmp(argv[i], "-l") && is_load)
+            level = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "-t") && is_load)
+            movetime_ms = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "-m") && is_load)
+            max_plies = atoi(argv[i + 1]);
+        else
+            return usage(argv[0]);
+    }
+    if ((argc - (is_load ? 2 : 1)) % 2)
+        return usage(argv[0]);
+    try
+    {
+        if (is_load)
+            return load(address, games, level, movetime_ms, max_plies);
+        Config config;
+        config.set_default("Bot", "BotScoringType", "NumberAndPotential");
+        config.set_default("Bot", "Optimization", "O1");
+        config.set_default("Bot", "NoRandom", true);
+        config.set("Bot", "NodesPerSecond", 0);
+        Server server(&config, address, threads);
+        signal(SIGINT, on_signal);
+        signal(SIGTERM, on_signal);
+        cerr << "Listening on " << address << "\n";
+        server.run(&stop_server);
+        cerr << server.stats().dump() << "\n";
+    }
+    catch (const exception &e)
+    {
+        cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,88 @@
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include "../Game/Tuner.h"
+
+// Подбор весов оценки "Weights" по сыгранным партиям
+// Использование: checkers_tune [-g games.pdn] -d positions.bin [-o weights.json] [-w start.json] [-j threads]
+//                              [-e epochs] [-r rate] [-s skip_plies]
+// С -g партии из PDN преобразуются в набор упакованных позиций positions.bin (файл перезаписывается),
+// с -o по набору подбираются веса и записываются в файл, который загружает бот (см. EvalWeights)
+static int usage(const char *name)
+{
+    cerr << "Usage: " << name
+         << " [-g games.pdn] -d positions.bin [-o weights.json] [-w start.json] [-j threads] [-e epochs] [-r rate]"
+            " [-s skip_plies]\n";
+    return 1;
+}
+
+int main(int argc, char *argv[])
+{
+    string games, dataset, output, start_path;
+    unsigned threads = 0;
+    int epochs = 300, skip_plies = 8;
+    double rate = 1.0;
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (!strcmp(argv[i], "-g"))
+            games = argv[i + 1];
+        else if (!strcmp(argv[i], "-d"))
+            dataset = argv[i + 1];
+        else if (!strcmp(argv[i], "-o"))
+            output = argv[i + 1];
+        else if (!strcmp(argv[i], "-w"))
+            start_path = argv[i + 1];
+        else if (!strcmp(argv[i], "-j"))
+            threads = unsigned(atoi(argv[i + 1]));
+        else if (!strcmp(argv[i], "-e"))
+            epochs = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "-r"))
+            rate = atof(argv[i + 1]);
+        else if (!strcmp(argv[i], "-s"))
+            skip_plies = atoi(argv[i + 1]);
+        else
+            return usage(argv[0]);
+    }
+    if (dataset.empty() || (games.empty() && output.empty()))
+        return usage(argv[0]);
+    try
+    {
+        auto start = chrono::steady_clock::now();
+        if (!games.empty())
+        {
+            ofstream fout(dataset, ios::binary | ios::trunc);
+            if (!fout.is_open())
+                throw runtime_error("can't open " + dataset);
+            write_dataset_header(fout);
+            const size_t count = pdn_to_dataset(games, fout, skip_plies);
+            cerr << "Wrote " << count << " positions to " << dataset << "\n";
+        }
+        if (output.empty())
+            return 0;
+
+        PositionsFile positions(dataset);
+        Tuner tuner(positions.data(), positions.size(), threads);
+        Evaluator evaluator;
+        if (!start_path.empty())
+            evaluator.load(start_path);
+        const auto initial = evaluator.get_weights();
+        cerr << "Loaded " << positions.size() << " positions, scale " << tuner.fit_scale(initial) << ", loss "
+             << tuner.loss(initial) << "\n";
+        auto weights = tuner.tune(initial, epochs, rate, [](const int epoch, const double loss) {
+            if (epoch % 50 == 0)
+                cerr << "Epoch " << epoch << " loss " << loss << "\n";
+        });
+        evaluator.set_weights(weights);
+        evaluator.save(output);
+        double sec = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        cerr << "Final loss " << tuner.loss(weights) << ", weights written to " << output << " (" << sec << " sec)\n";
+    }
+    catch (const exception &e)
+    {
+        cerr << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}